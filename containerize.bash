@@ -18,7 +18,7 @@ bdeps() {
 # Build-time only dependencies.
 bdeps git               # To get source code.
 bdeps cmake make python # Build tools.
-bdeps gcc gcc-fortran   # Compilers
+bdeps gcc               # Compilers
 bdeps boost             # Template lib.
 bdeps pacman-contrib    # For paccache.
 
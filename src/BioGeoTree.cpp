@@ -39,6 +39,71 @@ Superdouble MAX(const Superdouble &a, const Superdouble &b){
 	return b > a ? b:a;
 }
 
+template <typename Scalar>
+vector<Superdouble> to_superdouble(const vector<Scalar> & in){
+	vector<Superdouble> out(in.size());
+	for(unsigned int i=0;i<in.size();i++){
+		out[i] = scalar::to_superdouble(in[i]);
+	}
+	return out;
+}
+
+/*
+ * as doubles relative to the largest entry (all 0 if there is none)
+ */
+template <typename Scalar>
+vector<double> to_relative(const vector<Scalar> & in){
+	const Scalar zero(0);
+	Scalar largest = zero;
+	for(unsigned int i=0;i<in.size();i++){
+		if(in[i] != zero && (largest == zero || in[i] > largest))
+			largest = in[i];
+	}
+	vector<double> relative(in.size(), 0);
+	if(largest != zero){
+		for(unsigned int i=0;i<in.size();i++){
+			Scalar entry = in[i];
+			if(entry != zero)
+				relative[i] = double(entry / largest);
+		}
+	}
+	return relative;
+}
+
+/*
+ * out[j] += sum over i != skip of a[i]*p[i][j], the reverse propagation a.P
+ * P is walked row by row, contiguously, each out[j] still summing
+ * over i in increasing order
+ */
+template <typename Scalar>
+void add_vector_times_P(matrix::View p, vector<Scalar> & a, int skip, vector<Scalar> & out){
+	const int n = out.size();
+	for(int i=0;i<n;i++){
+		if(i == skip)
+			continue;
+		Scalar ai = a[i];
+		const double * row = p[i];
+		for(int j=0;j<n;j++)
+			out[j] += ai*row[j];
+	}
+}
+
+/*
+ * calls f with a zero of the numeric type chosen for the run,
+ * from which f takes the type of the conditionals (see scalar.hpp)
+ */
+template <typename F>
+auto BioGeoTree::dispatch(F f){
+	switch(scalar_type){
+	case scalar::Type::LongDouble:
+		return f((long double) 0);
+	case scalar::Type::Double:
+		return f(0.0);
+	default:
+		return f(Superdouble(0));
+	}
+}
+
 /*
  * sloppy beginning but best for now because of the complicated bits
  */
@@ -51,13 +116,12 @@ Superdouble MAX(const Superdouble &a, const Superdouble &b){
 //		stochastic(false),stored_EN_matrices(map<int,map<double, mat > >()),stored_EN_CX_matrices(map<int,map<double, cx_mat > >()),
 //		stored_ER_matrices(map<int,map<double, mat > >()),ultrametric(false),sim(false),ran_seed(314159265),sim_D(0.1),sim_E(0.1),
 //		readSimStates(false),true_D(0),true_E(0){
-BioGeoTree::BioGeoTree(Tree * tr, vector<double> ps):tree(tr),periods(ps),
+BioGeoTree::BioGeoTree(Tree * tr, vector<double> ps, scalar::Type st):tree(tr),periods(ps),scalar_type(st),
 		age("age"),dc("dist_conditionals"),en("excluded_dists"),
 		andc("anc_dist_conditionals"),columns(NULL),whichcolumns(NULL),rootratemodel(NULL),
 		distmap(NULL),store_p_matrices(false),use_stored_matrices(false),revB("revB"),
-		rev(false),rev_exp_number("rev_exp_number"),rev_exp_time("rev_exp_time"),
-		stochastic(false),ultrametric(false),sim(false),ran_seed(314159265),sim_D(0.1),sim_E(0.1),
-		readSimStates(false),true_D(0),true_E(0){
+		rev(false),stochastic(false),ultrametric(false),
+		readSimStates(false),true_D(0),true_E(0),evaluated_model(NULL),full_update(true){
 
 	/*
 	 * initialize each node with segments
@@ -129,12 +193,6 @@ BioGeoTree::BioGeoTree(Tree * tr, vector<double> ps):tree(tr),periods(ps),
 	 * (needed for some simulated topologies using independent software)
 	 */
 	tree->getRoot()->setPeriod(periods.size() - 1);
-	/*
-	 * Initialise the GSL RNG's
-	 */
-	gsl_rng_env_setup();
-	T = gsl_rng_default;
-	r = gsl_rng_alloc (T);
 }
 
 void BioGeoTree::set_store_p_matrices(bool i){
@@ -166,12 +224,16 @@ void BioGeoTree::print_segs(){
 			cout << "\tSeg" << j << "\tPeriod: " << tsegs->at(j).getPeriod() << "\tDuration: " << tsegs->at(j).getDuration() << endl;
 		}
 		if (!tmpNode->isRoot()) {
-			for(unsigned int k = 0; k < tsegs->at(0).distconds->size(); k++) {
-				if (double(tsegs->at(0).distconds->at(k)) != 0) {
-					cout << k << "(" << double(tsegs->at(0).distconds->at(k)) << ")";
-					cout << endl;
+			dispatch([&](auto zero){
+				typedef decltype(zero) Scalar;
+				vector<Scalar> * distconds = tsegs->at(0).conds<Scalar>().distconds;
+				for(unsigned int k = 0; k < distconds->size(); k++) {
+					if (double(distconds->at(k)) != 0) {
+						cout << k << "(" << double(distconds->at(k)) << ")";
+						cout << endl;
+					}
 				}
-			}
+			});
 		}
 //		if (tmpNode->isInternal()) {
 //			cout << "Children:";
@@ -187,22 +249,23 @@ void BioGeoTree::print_segs(){
 
 void BioGeoTree::set_default_model(RateModel * mod){
 	rootratemodel = mod;
-	for(int i=0;i<tree->getNodeCount();i++){
-		vector<BranchSegment> * tsegs = tree->getNode(i)->getSegVector();
-		for(unsigned int j=0;j<tsegs->size();j++){
-			tsegs->at(j).setModel(mod);
-			vector<Superdouble> * distconds = new vector<Superdouble> (rootratemodel->getDists()->size(),0);
-			tsegs->at(j).distconds = distconds;
-			vector<Superdouble> * ancdistconds = new vector<Superdouble> (rootratemodel->getDists()->size(),0);
-			tsegs->at(j).ancdistconds = ancdistconds;
+	evaluated_model = NULL;
+	dispatch([&](auto zero){
+		typedef decltype(zero) Scalar;
+		for(int i=0;i<tree->getNodeCount();i++){
+			vector<BranchSegment> * tsegs = tree->getNode(i)->getSegVector();
+			for(unsigned int j=0;j<tsegs->size();j++){
+				tsegs->at(j).setModel(mod);
+				vector<Scalar> * distconds = new vector<Scalar> (rootratemodel->getDists()->size(),zero);
+				tsegs->at(j).conds<Scalar>().distconds = distconds;
+				vector<Scalar> * ancdistconds = new vector<Scalar> (rootratemodel->getDists()->size(),zero);
+				tsegs->at(j).conds<Scalar>().ancdistconds = ancdistconds;
+			}
 		}
-	}
-	vector<Superdouble> * distconds = new vector<Superdouble> (rootratemodel->getDists()->size(),0);
-	tree->getRoot()->assocDoubleVector(dc,*distconds);
-	delete distconds;
-	vector<Superdouble> * ancdistconds = new vector<Superdouble> (rootratemodel->getDists()->size(),0);
-	tree->getRoot()->assocDoubleVector(andc,*ancdistconds);
-	delete ancdistconds;
+		vector<Scalar> distconds(rootratemodel->getDists()->size(),zero);
+		tree->getRoot()->assocDoubleVector(dc,distconds);
+		tree->getRoot()->assocDoubleVector(andc,distconds);
+	});
 }
 
 void BioGeoTree::update_default_model(RateModel * mod){
@@ -217,17 +280,31 @@ void BioGeoTree::update_default_model(RateModel * mod){
 }
 
 void BioGeoTree::set_tip_conditionals(map<string,vector<int> > distrib_data){
+	evaluated_model = NULL;
 	int numofleaves = tree->getExternalNodeCount();
 	for(int i=0;i<numofleaves;i++){
 		vector<BranchSegment> * tsegs = tree->getExternalNode(i)->getSegVector();
 		RateModel * mod = tsegs->at(0).getModel();
-		int ind1 = get_vector_int_index_from_multi_vector_int(
-				&distrib_data[tree->getExternalNode(i)->getName()],mod->getDists());
-		tsegs->at(0).distconds->at(ind1) = 1.0;
+		vector<int> & tipdist = distrib_data[tree->getExternalNode(i)->getName()];
+		int ind1 = mod->get_first_dist_int(tipdist);
+		if (ind1 < 0) {
+			cout << "the distribution ";
+			for (unsigned int j=0;j<tipdist.size();j++)
+				cout << tipdist[j];
+			cout << " is not included in the possible distributions" << endl;
+			exit(0);
+		}
+		dispatch([&](auto zero){
+			//	from scratch, should the tips be set again (see bootstrap.hpp)
+			vector<decltype(zero)> * distconds = tsegs->at(0).conds<decltype(zero)>().distconds;
+			fill(distconds->begin(), distconds->end(), zero);
+			distconds->at(ind1) = 1.0;
+		});
 	}
 }
 
 void BioGeoTree::set_excluded_dist(vector<int> ind,Node * node){
+	evaluated_model = NULL;
 	node->getExclDistVector()->push_back(ind);
 }
 
@@ -265,27 +342,63 @@ Superdouble BioGeoTree::eval_likelihood(bool marginal){
 		columns = new vector<int>(rootratemodel->getDists()->size());
 		whichcolumns = new vector<int>();
 	}
-	ancdist_conditional_lh(*tree->getRoot(),marginal);
+	/*
+	 * only the periods whose Q changed since the last evaluation need recomputing,
+	 * unless everything is to be stored for the reverse pass
+	 */
+	int nperiods = rootratemodel->get_num_periods();
+	full_update = evaluated_model != rootratemodel || store_p_matrices || use_stored_matrices
+			|| rootratemodel->sparse;
+	dirty_periods.assign(nperiods, full_update);
+	evaluated_versions.resize(nperiods);
+	for(int p=0;p<nperiods;p++){
+		unsigned long version = rootratemodel->get_Q_version(p);
+		if(version != evaluated_versions[p]){
+			dirty_periods[p] = true;
+			evaluated_versions[p] = version;
+		}
+		if(dirty_periods[p])
+			p_columns.erase(p);
+	}
+	evaluated_model = rootratemodel;
+	Superdouble lh = dispatch([&](auto zero){
+		typedef decltype(zero) Scalar;
+		ancdist_conditional_lh<Scalar>(*tree->getRoot(),marginal);
+		Scalar sum = calculate_vector_scalar_sum(*tree->getRoot()->getDoubleVector<Scalar>(dc));
+		/*
+		 * only Superdouble never underflows: with the other types
+		 * a likelihood out of range leaves nothing to optimize
+		 */
+		if constexpr (!is_same<Scalar, Superdouble>::value){
+			if (!(sum > 0) || !isfinite(sum)){
+				cerr << "Error: the likelihood (" << double(sum) << ") is out of the range of the scalar type '"
+					 << scalar::name(scalar_type) << "'.\nTry a wider one, among " << scalar::NAMES << "." << endl;
+				exit(scalar::UNDERFLOW_ERROR);
+			}
+		}
+		return scalar::to_superdouble(sum);
+	});
 	if( rootratemodel->sparse == true){
 		delete columns;
 		delete whichcolumns;
 	}
 //	return (-(log(calculate_vector_double_sum(*(vector<double>*) tree->getRoot()->getDoubleVector(dc)))));
-	return -(calculate_vector_Superdouble_sum(*(vector<Superdouble>*) tree->getRoot()->getDoubleVector(dc))).getLn();
+	return -lh.getLn();
 }
 
 
-vector<Superdouble> BioGeoTree::conditionals(Node & node, bool marginal,bool sparse){
-	vector<Superdouble> distconds;
+template <typename Scalar>
+vector<Scalar> BioGeoTree::conditionals(Node & node, bool marginal,bool sparse){
+	vector<Scalar> distconds;
 	vector<BranchSegment> * tsegs = node.getSegVector();
 
-	distconds = *tsegs->at(0).distconds;
+	distconds = *tsegs->at(0).conds<Scalar>().distconds;
 	for(unsigned int i=0;i<tsegs->size();i++){
 		for(unsigned int j=0;j<distconds.size();j++){
-			tsegs->at(i).distconds->at(j) = distconds.at(j);
+			tsegs->at(i).conds<Scalar>().distconds->at(j) = distconds.at(j);
 		}
 		RateModel * rm = tsegs->at(i).getModel();
-		vector<Superdouble> * v = new vector<Superdouble> (rootratemodel->getDists()->size(), 0);
+		vector<Scalar> * v = new vector<Scalar> (rootratemodel->getDists()->size(), 0);
 //		vector<int> distrange;
 //		if(tsegs->at(i).get_start_dist_int() != -666){
 //			int ind1 = tsegs->at(i).get_start_dist_int();
@@ -315,12 +428,74 @@ vector<Superdouble> BioGeoTree::conditionals(Node & node, bool marginal,bool spa
 		 * marginal
 		 */
 		if(marginal == true){
+			int period = tsegs->at(i).getPeriod();
+			double duration = tsegs->at(i).getDuration();
+			Scalar zero = 0;
+			/*
+			 * a single nonzero conditional (the tips): P.v is one column of P,
+			 * shared by all segments of the same period and duration starting from this range
+			 */
+			int single = -1;
 			if(sparse == false){
-				vector<vector<double > > p;
+				for(unsigned int j=0;j<distrange->size();j++){
+					if(distconds.at(distrange->at(j)) != zero){
+						single = (single == -1) ? j : -2;
+						if(single == -2)
+							break;
+					}
+				}
+			}
+			if(single >= 0){
+				map<int,vector<double> > & segcolumns = p_columns[period][duration];
+				vector<double> & column = segcolumns[single];
+				if(column.empty()){
+					if(use_stored_matrices == false && store_p_matrices == false){
+						column.assign(distrange->size(), 0);
+						column[single] = 1;
+						rm->setup_P_action(period,duration,column);
+					}else{
+						//	P is then computed and stored once per evaluation
+						if(use_stored_matrices == false && segcolumns.size() == 1)
+							rm->setup_pade_P(period,duration,store_p_matrices);
+						matrix::View p = rm->stored_p_matrices[period][duration];
+						column.resize(distrange->size());
+						for(unsigned int j=0;j<distrange->size();j++){
+							column[j] = p[j][single];
+						}
+					}
+				}
+				Scalar & cond = distconds.at(distrange->at(single));
+				for(unsigned int j=0;j<distrange->size();j++){
+					v->at(distrange->at(j)) = cond * column[j];
+				}
+			}else if(sparse == false && use_stored_matrices == false && store_p_matrices == false){
+				/*
+				 * P itself is not kept: propagate the conditionals directly,
+				 * scaled down to doubles
+				 * (zero is left out of comparisons, it does not compare correctly to small Superdoubles)
+				 */
+				Scalar scale = zero;
+				for(unsigned int j=0;j<distrange->size();j++){
+					Scalar & cond = distconds.at(distrange->at(j));
+					if(cond != zero && (scale == zero || cond > scale))
+						scale = cond;
+				}
+				if(scale != zero){
+					vector<double> w(distrange->size());
+					for(unsigned int j=0;j<distrange->size();j++){
+						w[j] = distconds.at(distrange->at(j)) / scale;
+					}
+					rm->setup_P_action(period,duration,w);
+					for(unsigned int j=0;j<distrange->size();j++){
+						v->at(distrange->at(j)) = scale * w[j];
+					}
+				}
+			}else if(sparse == false){
+				matrix::View p;
 				if(use_stored_matrices == false){
-					p= rm->setup_fortran_P(tsegs->at(i).getPeriod(),tsegs->at(i).getDuration(),store_p_matrices);
+					p = rm->setup_pade_P(period,duration,store_p_matrices);
 				}else{
-					p = rm->stored_p_matrices[tsegs->at(i).getPeriod()][tsegs->at(i).getDuration()];
+					p = rm->stored_p_matrices[period][duration];
 				}
 //				for(unsigned int j=0;j<distrange.size();j++){
 //					for(unsigned int k=0;k<distconds.size();k++){
@@ -368,7 +543,7 @@ vector<Superdouble> BioGeoTree::conditionals(Node & node, bool marginal,bool spa
 		 */
 //		else{
 //			if(sparse == false){
-//				vector<vector<double > > p = rm->setup_fortran_P(tsegs->at(i).getPeriod(),tsegs->at(i).getDuration(),store_p_matrices);
+//				vector<vector<double > > p = rm->setup_pade_P(tsegs->at(i).getPeriod(),tsegs->at(i).getDuration(),store_p_matrices);
 //				for(unsigned int j=0;j<distrange.size();j++){
 //					Superdouble maxnum = 0;
 //					for(unsigned int k=0;k<distconds.size();k++){
@@ -385,20 +560,30 @@ vector<Superdouble> BioGeoTree::conditionals(Node & node, bool marginal,bool spa
 			distconds[j] = v->at(j);
 		}
 		if(store_p_matrices == true){
-			tsegs->at(i).seg_sp_alphas = distconds;
+			tsegs->at(i).conds<Scalar>().seg_sp_alphas = distconds;
 		}
 		delete v;
 	}
 	/*
-	 * if store is true we want to store the conditionals for each node
-	 * for possible use in ancestral state reconstruction
+	 * store the conditionals at the top of each branch,
+	 * for use in ancestral state reconstruction and by the next evaluation
 	 */
-	if(store_p_matrices == true){
-		tsegs->at(0).alphas = distconds;
-	}
+	tsegs->at(0).conds<Scalar>().alphas = distconds;
 	return distconds;
 }
 
+/*
+ * whether the branch above node goes through a period changed since the last evaluation
+ */
+bool BioGeoTree::branch_changed(Node & node){
+	vector<BranchSegment> * tsegs = node.getSegVector();
+	for(unsigned int i=0;i<tsegs->size();i++){
+		if(dirty_periods[tsegs->at(i).getPeriod()])
+			return true;
+	}
+	return false;
+}
+
 #ifdef DEBUG
 //void LR_print(vector<int> leftdists, vector<int> rightdists) {
 //	cout << "leftdists: ";
@@ -412,8 +597,16 @@ vector<Superdouble> BioGeoTree::conditionals(Node & node, bool marginal,bool spa
 //}
 #endif
 
-void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
-	vector<Superdouble> distconds(rootratemodel->getDists()->size(), 0);
+/*
+ * returns whether the conditionals of node changed:
+ * those left unchanged, and the conditionals at the top of unchanged branches
+ * (the alphas), are reused from the last evaluation
+ */
+template <typename Scalar>
+bool BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
+	if (full_update == false && node.isExternal() == true)
+		return false;
+	vector<Scalar> distconds(rootratemodel->getDists()->size(), 0);
 	if (node.isExternal()==false){//is not a tip
 		Node * c1 = &node.getChild(0);
 		Node * c2 = &node.getChild(1);
@@ -424,8 +617,10 @@ void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
 		}else{
 			model = rootratemodel;
 		}
-		ancdist_conditional_lh(*c1,marginal);
-		ancdist_conditional_lh(*c2,marginal);
+		bool c1changed = ancdist_conditional_lh<Scalar>(*c1,marginal) || branch_changed(*c1);
+		bool c2changed = ancdist_conditional_lh<Scalar>(*c2,marginal) || branch_changed(*c2);
+		if (full_update == false && c1changed == false && c2changed == false)
+			return false;
 
 #ifdef DEBUG
 		if (node.isRoot())
@@ -434,14 +629,14 @@ void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
 #endif
 
 		bool sparse = rootratemodel->sparse;
-		vector<Superdouble> v1;
-		vector<Superdouble> v2;
+		vector<Scalar> v1;
+		vector<Scalar> v2;
 		if(sparse == true){
 			//getcolumns
 			vector<BranchSegment> * c1tsegs = c1->getSegVector();
 			vector<BranchSegment> * c2tsegs = c2->getSegVector();
-			vector<int> lcols = get_columns_for_sparse(*c1tsegs->at(0).distconds,rootratemodel);
-			vector<int> rcols = get_columns_for_sparse(*c2tsegs->at(0).distconds,rootratemodel);
+			vector<int> lcols = get_columns_for_sparse(*c1tsegs->at(0).conds<Scalar>().distconds,rootratemodel);
+			vector<int> rcols = get_columns_for_sparse(*c2tsegs->at(0).conds<Scalar>().distconds,rootratemodel);
 			whichcolumns->clear();
 			for(unsigned int i=0;i<lcols.size();i++){
 				if(lcols[i]==1 || rcols[i] ==1){
@@ -460,8 +655,14 @@ void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
 			columns->at(0) = 0;
 		}
 
-		v1 =conditionals(*c1,marginal,sparse);
-		v2 =conditionals(*c2,marginal,sparse);
+		if (full_update == true || c1changed == true)
+			v1 =conditionals<Scalar>(*c1,marginal,sparse);
+		else
+			v1 = c1->getSegVector()->at(0).conds<Scalar>().alphas;
+		if (full_update == true || c2changed == true)
+			v2 =conditionals<Scalar>(*c2,marginal,sparse);
+		else
+			v2 = c2->getSegVector()->at(0).conds<Scalar>().alphas;
 
 #ifdef DEBUG
 //		cout << "At internal node #" << node.getNumber() << endl
@@ -484,25 +685,16 @@ void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
 #endif
 
 		vector<vector<int> > * dists = rootratemodel->getDists();
-		vector<int> leftdists;
-		vector<int> rightdists;
-		double weight;
 		//cl1 = clock();
 
 		for (unsigned int i=0;i<dists->size();i++){
 
 			if(accumulate(dists->at(i).begin(),dists->at(i).end(),0) > 0){
-				Superdouble lh = 0.0;
+				Scalar lh = 0.0;
 				vector<vector<int> >* exdist = node.getExclDistVector();
 				int cou = count(exdist->begin(),exdist->end(),dists->at(i));
 				if(cou == 0){
-					iter_ancsplits_just_int(rootratemodel,dists->at(i),leftdists,rightdists,weight,node.getPeriod());
-					for (unsigned int j=0;j<leftdists.size();j++){
-						int ind1 = leftdists[j];
-						int ind2 = rightdists[j];
-						Superdouble lh_part = v1.at(ind1)*v2.at(ind2);
-						lh += (lh_part * weight);
-					}
+					lh = rootratemodel->get_split_likelihood(i,node.getPeriod(),v1,v2);
 				}
 				distconds.at(i)= lh;
 			}
@@ -525,7 +717,7 @@ void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
 		cout << "Analyzing external node : " << node.getName() << endl;
 #endif
 		vector<BranchSegment> * tsegs = node.getSegVector();
-		distconds = *tsegs->at(0).distconds;
+		distconds = *tsegs->at(0).conds<Scalar>().distconds;
 	}
 	//testing scale
 	//if (run_with_scale){
@@ -535,23 +727,24 @@ void BioGeoTree::ancdist_conditional_lh(Node & node, bool marginal){
 	if(node.hasParent() == true){
 		vector<BranchSegment> * tsegs = node.getSegVector();
 		for(unsigned int i=0;i<distconds.size();i++){
-			tsegs->at(0).distconds->at(i) = distconds.at(i);
+			tsegs->at(0).conds<Scalar>().distconds->at(i) = distconds.at(i);
 		}
 #ifdef DEBUG
 		cout << "Fractional likelihood sum at this node : "
-			 << calculate_vector_Superdouble_sum(*(tsegs->at(0).distconds)) << endl << endl;
+			 << calculate_vector_scalar_sum(*(tsegs->at(0).conds<Scalar>().distconds)) << endl << endl;
 #endif
 	}
 	else{
 		for(unsigned int i=0;i<distconds.size();i++){
-			node.getDoubleVector(dc)->at(i) = distconds.at(i);
+			node.getDoubleVector<Scalar>(dc)->at(i) = distconds.at(i);
 			//cout << distconds.at(i) << endl;
 		}
 #ifdef DEBUG
 		cout << "Global likelihood at the ROOT : "
-			 << calculate_vector_Superdouble_sum(*(node.getDoubleVector(dc))) << endl << endl;
+			 << calculate_vector_scalar_sum(*(node.getDoubleVector<Scalar>(dc))) << endl << endl;
 #endif
 	}
+	return true;
 }
 
 void BioGeoTree::set_ultrametric(bool ultMet)
@@ -567,6 +760,7 @@ void BioGeoTree::set_ultrametric(bool ultMet)
  * ********************************************
  */
 void BioGeoTree::setFossilatNodeByMRCA(vector<string> nodeNames, int fossilarea){
+	evaluated_model = NULL;
 	Node * mrca = tree->getMRCA(nodeNames);
 	vector<vector<int> > * dists = rootratemodel->getDists();
 	for(unsigned int i=0;i<dists->size();i++){
@@ -577,6 +771,7 @@ void BioGeoTree::setFossilatNodeByMRCA(vector<string> nodeNames, int fossilarea)
 	}
 }
 void BioGeoTree::setFossilatNodeByMRCA_id(Node * id, int fossilarea){
+	evaluated_model = NULL;
 	vector<vector<int> > * dists = rootratemodel->getDists();
 	for(unsigned int i=0;i<dists->size();i++){
 		if(dists->at(i).at(fossilarea) == 0){
@@ -627,161 +822,155 @@ void BioGeoTree::setFossilatExternalBranchByMRCA_id(Node * id, int fossilarea, d
  ************************************************************/
 //add joint
 void BioGeoTree::prepare_ancstate_reverse(){
-	reverse(*tree->getRoot());
+	dispatch([&](auto zero){
+		reverse<decltype(zero)>(*tree->getRoot());
+	});
+}
+
+/*
+ * only for the given nodes: the reverse pass follows the paths from the root,
+ * the sisters along the way only lending their alphas
+ */
+void BioGeoTree::prepare_ancstate_reverse(const vector<Node *> & nodes){
+	set<Node *> path;
+	for(unsigned int i=0;i<nodes.size();i++){
+		for(Node * n = nodes[i]; n != NULL && path.insert(n).second; n = n->getParent()){}
+	}
+	dispatch([&](auto zero){
+		reverse<decltype(zero)>(*tree->getRoot(),&path);
+	});
 }
 
 /*
  * called from prepare_ancstate_reverse and that is all
+ * descends into every child, or only those on the path if any
  */
-void BioGeoTree::reverse(Node & node){
+template <typename Scalar>
+void BioGeoTree::reverse(Node & node, const set<Node *> * path){
 	rev = true;
-	vector<Superdouble> * revconds = new vector<Superdouble> (rootratemodel->getDists()->size(), 0);//need to delete this at some point
+	vector<Scalar> * revconds = new vector<Scalar> (rootratemodel->getDists()->size(), 0);//need to delete this at some point
 	if (&node == tree->getRoot()) {
 		vector<vector<int> > * inc_dists = rootratemodel->get_incldists_per_period(node.getPeriod());
-		map<vector<int>,int> * distsmap = rootratemodel->get_dists_int_map();
 		vector<vector<int> > * exdist = node.getExclDistVector();
 		for(unsigned int i=0;i<inc_dists->size();i++){
 			int cou = count(exdist->begin(), exdist->end(), inc_dists->at(i));
 			if (cou == 0)
-				revconds->at((*distsmap)[inc_dists->at(i)]) = 1.0;//prior
+				revconds->at(rootratemodel->get_dist_int(inc_dists->at(i))) = 1.0;//prior
 			else
-				revconds->at((*distsmap)[inc_dists->at(i)]) = 0.0;//prior
+				revconds->at(rootratemodel->get_dist_int(inc_dists->at(i))) = 0.0;//prior
 		}
 
 		node.assocDoubleVector(revB,*revconds);
 		delete revconds;
 		for(int i = 0;i<node.getChildCount();i++){
-			reverse(node.getChild(i));
+			if(path == NULL || path->count(&node.getChild(i)) > 0)
+				reverse<Scalar>(node.getChild(i),path);
 		}
 	}
-	else if(node.isExternal() == false){
+	else if(node.isExternal() == false || stochastic == true){
 		//calculate A i
 		//sum over all alpha k of sister node of the parent times the priors of the speciations
 		//(weights) times B of parent j
-		vector<Superdouble> * parrev = node.getParent()->getDoubleVector(revB);
-		vector<Superdouble> sisdistconds;
-		if(&node.getParent()->getChild(0) != &node){
-			vector<BranchSegment> * tsegs = node.getParent()->getChild(0).getSegVector();
-			sisdistconds = tsegs->at(0).alphas;
+		//the split, and the ranges excluded there, are those of the parent
+		Node * parent = node.getParent();
+		vector<Scalar> * parrev = parent->getDoubleVector<Scalar>(revB);
+		vector<Scalar> sisdistconds;
+		if(&parent->getChild(0) != &node){
+			vector<BranchSegment> * tsegs = parent->getChild(0).getSegVector();
+			sisdistconds = tsegs->at(0).conds<Scalar>().alphas;
 		}else{
-			vector<BranchSegment> * tsegs = node.getParent()->getChild(1).getSegVector();
-			sisdistconds = tsegs->at(0).alphas;
+			vector<BranchSegment> * tsegs = parent->getChild(1).getSegVector();
+			sisdistconds = tsegs->at(0).conds<Scalar>().alphas;
 		}
 		vector<vector<int> > * dists = rootratemodel->getDists();
-		vector<int> leftdists;
-		vector<int> rightdists;
-		double weight;
 		//cl1 = clock();
-		vector<Superdouble> tempA (rootratemodel->getDists()->size(),0);
+		vector<Scalar> tempA (rootratemodel->getDists()->size(),0);
+		vector<vector<int> > * exdist = parent->getExclDistVector();
 		for (unsigned int i = 0; i < dists->size(); i++) {
 			if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
-				vector<vector<int> > * exdist = node.getExclDistVector();
 				int cou = count(exdist->begin(), exdist->end(), dists->at(i));
 				if (cou == 0) {
-					iter_ancsplits_just_int(rootratemodel, dists->at(i), leftdists, rightdists, weight, node.getPeriod());
 					//root has i, curnode has left, sister of cur has right
-					for (unsigned int j = 0; j < leftdists.size(); j++) {
-						int ind1 = leftdists[j];
-						int ind2 = rightdists[j];
-						tempA[ind1] += (sisdistconds.at(ind2)*weight*parrev->at(i));
-					}
+					rootratemodel->add_split_reverse(i, parent->getPeriod(), parrev->at(i), sisdistconds, tempA);
 				}
 			}
 		}
 
 		//now calculate node B
 		vector<BranchSegment>* tsegs = node.getSegVector();
-		vector<Superdouble> tempmoveA(tempA);
+		vector<Scalar> tempmoveA(tempA);
 		//for(unsigned int ts=0;ts<tsegs->size();ts++){
 		for(int ts = tsegs->size()-1;ts != -1;ts--){
+			if(stochastic == true)
+				tsegs->at(ts).conds<Scalar>().seg_sp_revA = tempmoveA;
 			for(unsigned int j=0;j<dists->size();j++){revconds->at(j) = 0;}
 			RateModel * rm = tsegs->at(ts).getModel();
-			vector<vector<double > > * p = &rm->stored_p_matrices[tsegs->at(ts).getPeriod()][tsegs->at(ts).getDuration()];
-//			mat * EN = NULL;
-//			mat * ER = NULL;
-			vector<Superdouble> tempmoveAer(tempA);
-			vector<Superdouble> tempmoveAen(tempA);
-			if(stochastic == true){
-				//initialize the segment B's
-				for(unsigned int j=0;j<dists->size();j++){tempmoveAer[j] = 0;}
-				for(unsigned int j=0;j<dists->size();j++){tempmoveAen[j] = 0;}
-//				EN = &stored_EN_matrices[tsegs->at(ts).getPeriod()][tsegs->at(ts).getDuration()];
-//				ER = &stored_ER_matrices[tsegs->at(ts).getPeriod()][tsegs->at(ts).getDuration()];
-				//cout << (*EN) << endl;
-//				cx_mat * EN_CX = NULL;
-//				EN_CX = &stored_EN_CX_matrices[tsegs->at(ts).getPeriod()][tsegs->at(ts).getDuration()];
-				//cout << (*EN_CX) << endl;
-				//exit(0);
-			}
-//			for(unsigned int j=0;j < dists->size();j++){
-//				if(accumulate(dists->at(j).begin(), dists->at(j).end(), 0) > 0){
-//					for (unsigned int i = 0; i < dists->size(); i++) {
-//						if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
-//							//cout << "here " << j << " " << i<< " " << node.getBL() << " " << ts <<" " << tsegs->size() << endl;
-//							revconds->at(j) += tempmoveA[i]*((*p)[i][j]);//tempA needs to change each time
-//							//cout << "and" << endl;
-//							if(stochastic == true){
-//								tempmoveAer[j] += tempmoveA[i]*(((*ER)(i,j)));
-//								tempmoveAen[j] += tempmoveA[i]*(((*EN)(i,j)));
-//							}
-//						}
-//					}
-//				}
-//			}
+			matrix::View p = rm->stored_p_matrices[tsegs->at(ts).getPeriod()][tsegs->at(ts).getDuration()];
 			//	the adjacency per time period version below
+			//	the empty range, if included, neither sends nor receives
 			vector<int> * validists = rootratemodel->get_incldistsint_per_period(tsegs->at(ts).getPeriod());
-			for(unsigned int j=0;j < validists->size();j++)
-				if(accumulate(dists->at(validists->at(j)).begin(), dists->at(validists->at(j)).end(), 0) > 0)
-					for (unsigned int i = 0; i < validists->size(); i++)
-						if (accumulate(dists->at(validists->at(i)).begin(), dists->at(validists->at(i)).end(), 0) > 0) {
-//							revconds->at(validists->at(j)) += tempmoveA[i]*((*p)[i][j]);//tempA needs to change each time
-							revconds->at(validists->at(j)) += tempmoveA[validists->at(i)]*((*p)[i][j]);//tempA needs to change each time
-						}
+			const int nvalid = validists->size();
+			int empty = -1;
+			vector<Scalar> segA(nvalid);
+			vector<Scalar> segB(nvalid, Scalar(0));
+			for(int i=0;i<nvalid;i++){
+				vector<int> & dist = dists->at(validists->at(i));
+				if(accumulate(dist.begin(), dist.end(), 0) == 0)
+					empty = i;
+				segA[i] = tempmoveA[validists->at(i)];//tempA needs to change each time
+			}
+			add_vector_times_P(p, segA, empty, segB);
+			for(int j=0;j<nvalid;j++)
+				if(j != empty)
+					revconds->at(validists->at(j)) = segB[j];
 
 			for(unsigned int j=0;j<dists->size();j++)
 				tempmoveA[j] = revconds->at(j);
-
-			if(stochastic == true){
-				tsegs->at(ts).seg_sp_stoch_map_revB_time = tempmoveAer;
-				tsegs->at(ts).seg_sp_stoch_map_revB_number = tempmoveAen;
-			}
 		}
-		node.assocDoubleVector(revB,*revconds);
+		//tips only get here for the expectations, which need no B of their own
+		if(node.isExternal() == false)
+			node.assocDoubleVector(revB,*revconds);
 		delete revconds;
 		for(int i = 0;i<node.getChildCount();i++){
-			reverse(node.getChild(i));
+			if(path == NULL || path->count(&node.getChild(i)) > 0)
+				reverse<Scalar>(node.getChild(i),path);
 		}
 	}
+	else
+		delete revconds;
 }
 
 /*
  * calculates the most likely split (not state) -- the traditional result for lagrange
+ * the likelihood of each split is written in place of the flat split table
+ * of the node's period (see cladogenesis.hpp), reading the conditionals where they are
  */
 
-map<vector<int>,vector<AncSplit> > BioGeoTree::calculate_ancsplit_reverse(Node & node,bool marg){
-	vector<Superdouble> * Bs = node.getDoubleVector(revB);
-	map<vector<int>,vector<AncSplit> > ret;
+vector<Superdouble> BioGeoTree::calculate_ancsplit_reverse(Node & node,bool marg){
+	return dispatch([&](auto zero){
+		return calculate_ancsplit_reverse<decltype(zero)>(node,marg);
+	});
+}
+
+template <typename Scalar>
+vector<Superdouble> BioGeoTree::calculate_ancsplit_reverse(Node & node,bool marg){
+	const cladogenesis::Splits & splits = rootratemodel->get_splits_per_period(node.getPeriod());
+	vector<Superdouble> ret(splits.size(),Superdouble(0));
+	if (node.isExternal()==true)
+		return ret;
+	vector<Scalar> & Bs = *node.getDoubleVector<Scalar>(revB);
+	vector<Scalar> & v1 = node.getChild(0).getSegVector()->at(0).conds<Scalar>().alphas;
+	vector<Scalar> & v2 = node.getChild(1).getSegVector()->at(0).conds<Scalar>().alphas;
+	vector<vector<int> > * exdist = node.getExclDistVector();
 	for(unsigned int j=0;j<rootratemodel->getDists()->size();j++){
-		vector<int> dist = rootratemodel->getDists()->at(j);
-		vector<AncSplit> ans = iter_ancsplits(rootratemodel,dist,node.getPeriod());
-		if (node.isExternal()==false){//is not a tip
-			Node * c1 = &node.getChild(0);
-			Node * c2 = &node.getChild(1);
-			vector<BranchSegment> * tsegs1 = c1->getSegVector();
-			vector<BranchSegment> * tsegs2 = c2->getSegVector();
-			for (unsigned int i=0;i<ans.size();i++){
-				vector<vector<int> > * exdist = node.getExclDistVector();
-				int cou = count(exdist->begin(), exdist->end(), (*rootratemodel->get_int_dists_map())[ans[i].ancdistint]);
-				if (cou == 0) {
-					vector<Superdouble> v1  =tsegs1->at(0).alphas;
-					vector<Superdouble> v2 = tsegs2->at(0).alphas;
-					Superdouble lh = (v1[ans[i].ldescdistint]*v2[ans[i].rdescdistint]*Bs->at(j)*ans[i].getWeight());
-					ans[i].setLikelihood(lh);
-					//cout << lh << endl;
-				}
-			}
+		int n = splits.n_splits(j);
+		if (n == 0 || count(exdist->begin(), exdist->end(), rootratemodel->getDists()->at(j)) > 0)
+			continue;
+		double weight = 1.0/n;
+		for (int k=splits.first(j);k<splits.first(j)+n;k++){
+			Scalar lh = (v1[splits.left_of(k)]*v2[splits.right_of(k)]*Bs[j]*weight);
+			ret[k] = scalar::to_superdouble(lh);
 		}
-		ret[dist] = ans;
 	}
 	return ret;
 }
@@ -790,194 +979,65 @@ map<vector<int>,vector<AncSplit> > BioGeoTree::calculate_ancsplit_reverse(Node &
  * calculates the ancestral area over all the possible states
  */
 vector<Superdouble> BioGeoTree::calculate_ancstate_reverse(Node & node,bool marg){
+	return dispatch([&](auto zero){
+		return to_superdouble(calculate_ancstate_reverse<decltype(zero)>(node,marg));
+	});
+}
+
+template <typename Scalar>
+vector<Scalar> BioGeoTree::calculate_ancstate_reverse(Node & node,bool marg){
 	if (node.isExternal()==false){//is not a tip
-		vector<Superdouble> * Bs = node.getDoubleVector(revB);
+		vector<Scalar> * Bs = node.getDoubleVector<Scalar>(revB);
 		vector<vector<int> > * dists = rootratemodel->getDists();
-		vector<int> leftdists;
-		vector<int> rightdists;
-		double weight;
 		Node * c1 = &node.getChild(0);
 		Node * c2 = &node.getChild(1);
 		vector<BranchSegment>* tsegs1 = c1->getSegVector();
 		vector<BranchSegment>* tsegs2 = c2->getSegVector();
-		vector<Superdouble> v1  =tsegs1->at(0).alphas;
-		vector<Superdouble> v2 = tsegs2->at(0).alphas;
-		vector<Superdouble> LHOODS (dists->size(),0);
+		vector<Scalar> & v1 = tsegs1->at(0).conds<Scalar>().alphas;
+		vector<Scalar> & v2 = tsegs2->at(0).conds<Scalar>().alphas;
+		vector<Scalar> LHOODS (dists->size(),0);
 		for (unsigned int i = 0; i < dists->size(); i++) {
 			if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
 				vector<vector<int> > * exdist = node.getExclDistVector();
 				int cou = count(exdist->begin(), exdist->end(), dists->at(i));
 				if (cou == 0) {
-					iter_ancsplits_just_int(rootratemodel, dists->at(i),leftdists, rightdists, weight, node.getPeriod());
-					for (unsigned int j=0;j<leftdists.size();j++){
-						int ind1 = leftdists[j];
-						int ind2 = rightdists[j];
-						LHOODS[i] += (v1.at(ind1)*v2.at(ind2)*weight);
-					}
-					LHOODS[i] *= Bs->at(i);
+					LHOODS[i] = rootratemodel->get_split_likelihood(i, node.getPeriod(), v1, v2) * Bs->at(i);
 				}
 			}
 		}
 		return LHOODS;
 	}
-	return vector<Superdouble> ();
-}
-
-
-/************************************************************************
- simulate ancestral states on BioGeoTree following a pre-order traversal
- ************************************************************************/
-void BioGeoTree::prepare_simulation(unsigned long int seed, bool ranPar)
-{
-	sim = true;
-
-	ran_seed = seed;
-	gsl_rng_set(r, ran_seed);
-	if (ranPar) {
-		do {
-			sim_D = gsl_ran_flat(r, 0, 1) * 0.2;
-			sim_E = gsl_ran_flat(r, 0, 1) * 0.2;
-		} while ((sim_D != 0) && (sim_E != 0) && (sim_D <= sim_E));
-	}
-	else {
-		if (sim_D < sim_E)
-			cout << "\nNote that manually setting the rate of geographic dispersal to be less than that of extinction"
-					"\nwill lead to highly trivial biogeographic histories. Continuing anyway..." << endl;
-	}
-
-	rootratemodel->setup_D(sim_D);
-	rootratemodel->setup_E(sim_E);
-	rootratemodel->setup_Q_with_adjacency();
-	update_default_model(rootratemodel);
-
-	cout << "dispersal : " << sim_D << "\textinction : " << sim_E << "\tseed : " << ran_seed;
-	simulate(*tree->getRoot());
+	return vector<Scalar> ();
 }
 
 /*
- * called from prepare_simulation and that is all
+ * the conditionals left by the last likelihood evaluation, as doubles
+ * relative to the largest one, which is all it takes to draw from them:
+ * at the end of segment seg of the branch above node (towards the tips),
+ * or at the top of the branch if seg is past its last segment;
+ * at the root, those of the root itself
  */
-void BioGeoTree::simulate(Node & node)
-{
-	if (&node == tree->getRoot()) {
-		vector<Superdouble> simconds = vector<Superdouble> (rootratemodel->getDists()->size(), 0);
-		vector<vector<int> > * inc_dists = rootratemodel->get_incldists_per_period(node.getPeriod());
-		map<vector<int>,int> * distsintmap = rootratemodel->get_dists_int_map();
-		vector<vector<int> > * exdist = node.getExclDistVector();
-
-		//	randomly choose the ROOT dist
-		size_t root_dist;
-		do {
-			root_dist = size_t(floor(gsl_ran_flat(r, 1, inc_dists->size())));
-		} while (count(exdist->begin(), exdist->end(), inc_dists->at(root_dist)) != 0);
-
-		//	set the ROOT prior for the forward simulation
-		simconds.at((*distsintmap)[inc_dists->at(root_dist)]) = 1.0;
-		tt.summarizeSimState(node,simconds,rootratemodel);
-
-		//	randomly choose the speciation model (i.e. the dist split)
-		vector<vector<vector<int> > > * splits = rootratemodel->get_iter_dist_splits_per_period(inc_dists->at(root_dist),node.getPeriod());
-		int splitIdx = int(floor(gsl_ran_flat(r, 0, splits->at(0).size())));
-		node.setIntObject("simsplit",splitIdx);
-
-#ifdef DEBUG
-		cout << "considered dist : " << print_area_vector(inc_dists->at(root_dist),*rootratemodel->get_areanamemaprev())
-			 << "\tno. of splits : " << splits->at(0).size()
-			 << "\tchosen split : " << splitIdx << " (" << print_area_vector(splits->at(0)[splitIdx],*rootratemodel->get_areanamemaprev()) << ")" << endl;
-		cout << "Left split\tRight split" << endl;
-		for (size_t spl = 0; spl < splits->at(0).size(); spl++)
-			cout << print_area_vector(splits->at(0)[spl],*rootratemodel->get_areanamemaprev())
-				 << "\t" << print_area_vector(splits->at(1)[spl],*rootratemodel->get_areanamemaprev()) << endl;
-#endif
-
-	}
-	else {
-		vector<vector<int> > * dists = rootratemodel->getDists();
-		map<vector<int>,int> * distsintmap = rootratemodel->get_dists_int_map();
-		map<int,vector<int> > * intdistsmap = rootratemodel->get_int_dists_map();
-		vector<vector<vector<int> > > * ancSplits = rootratemodel->get_iter_dist_splits_per_period((*intdistsmap)[*(node.getParent()->getIntObject("simdistidx"))],node.getParent()->getPeriod());
-		vector<Superdouble> simconds = vector<Superdouble> (dists->size(), 0);
-
-		//	the rule here for assigning the randomly chosen parent dist split
-		//	child(0) gets the corresponding "left" split
-		//	child(1) gets the corresponding "right" split
-		int ancSplitIdx = (*node.getParent()->getIntObject("simsplit"));
-
-#ifdef DEBUG
-		cout << "\nStart dist : " << print_area_vector(ancSplits->at(0)[ancSplitIdx],*rootratemodel->get_areanamemaprev()) << endl;
-#endif
-
-		//	set the node prior for the forward simulation
-		if(&node.getParent()->getChild(0) == &node)
-			simconds.at((*distsintmap)[ancSplits->at(0)[ancSplitIdx]]) = 1.0;
+vector<double> BioGeoTree::relative_conditionals(Node & node, unsigned int seg){
+	return dispatch([&](auto zero){
+		typedef decltype(zero) Scalar;
+		vector<Scalar> * conds;
+		if(node.hasParent() == false)
+			conds = node.getDoubleVector<Scalar>(dc);
+		else if(seg < node.getSegVector()->size())
+			conds = node.getSegVector()->at(seg).conds<Scalar>().distconds;
 		else
-			simconds.at((*distsintmap)[ancSplits->at(1)[ancSplitIdx]]) = 1.0;
-
-		vector<BranchSegment>* tsegs = node.getSegVector();
-#ifdef DEBUG
-		cout << "Seg size : " << tsegs->size() << endl;
-		cout << "Prior sum : " << calculate_vector_Superdouble_sum(simconds) << endl;
-#endif
-
-		for(int ts = tsegs->size() - 1; ts != -1; ts--) {
-			vector<Superdouble> * segconds = new vector<Superdouble> (dists->size(), 0);
-			RateModel * rm = tsegs->at(ts).getModel();
-			vector<vector<double > > p = rm->setup_fortran_P(tsegs->at(ts).getPeriod(),tsegs->at(ts).getDuration(),false);
-			vector<int> * validists = rm->get_incldistsint_per_period(tsegs->at(ts).getPeriod());
-
-			for(unsigned int j=0;j < validists->size();j++)
-				for (unsigned int i = 0; i < validists->size(); i++)
-					segconds->at(validists->at(j)) += simconds[validists->at(i)] * p[i][j];
-
-			for(unsigned int j=0;j<dists->size();j++)
-				simconds[j] = segconds->at(j);
-
-			delete segconds;
-		}
-
-		tt.summarizeSimState(node,simconds,rootratemodel);
-
-		//	randomly choose the speciation model (i.e. the dist split)
-		if (node.isInternal()) {
-			vector<vector<vector<int> > > * nodeSplits = rootratemodel->get_iter_dist_splits_per_period((*intdistsmap)[*(node.getIntObject("simdistidx"))],node.getPeriod());
-			int splitIdx = int(floor(gsl_ran_flat(r, 0, nodeSplits->at(0).size())));
-			node.setIntObject("simsplit",splitIdx);
-
-#ifdef DEBUG
-			cout << "considered dist : " << print_area_vector((*intdistsmap)[*(node.getIntObject("simdistidx"))],*rootratemodel->get_areanamemaprev())
-				 << "\tno. of splits : " << nodeSplits->at(0).size()
-				 << "\tchosen split : " << splitIdx << " (" << print_area_vector(nodeSplits->at(0)[splitIdx],*rootratemodel->get_areanamemaprev()) << ")" << endl;
-			cout << "Left split\tRight split" << endl;
-			for (size_t spl = 0; spl < nodeSplits->at(0).size(); spl++)
-				cout << print_area_vector(nodeSplits->at(0)[spl],*rootratemodel->get_areanamemaprev())
-					 << "\t" << print_area_vector(nodeSplits->at(1)[spl],*rootratemodel->get_areanamemaprev()) << endl;
-#endif
-
-		}
-	}
-
-	for(int i = 0;i<node.getChildCount();i++)
-		simulate(node.getChild(i));
+			conds = &node.getSegVector()->at(0).conds<Scalar>().alphas;
+		return to_relative(*conds);
+	});
 }
 
-double BioGeoTree::getSim_D()
-{
-	return sim_D;
-}
-
-double BioGeoTree::getSim_E()
-{
-	return sim_E;
-}
-
-void BioGeoTree::setSim_D(const double disp)
-{
-	sim_D = disp;
-}
-
-void BioGeoTree::setSim_E(const double ext)
-{
-	sim_E = ext;
+/*
+ * the conditionals of the root, as left by the last likelihood evaluation
+ */
+vector<Superdouble> BioGeoTree::root_conditionals(){
+	return dispatch([&](auto zero){
+		return to_superdouble(*tree->getRoot()->getDoubleVector<decltype(zero)>(dc));
+	});
 }
 
 void BioGeoTree::read_true_states(string truestatesfile)
@@ -1037,198 +1097,29 @@ double BioGeoTree::getTrue_E()
 }
 
 /**********************************************************
- * forward and reverse stuff for stochastic mapping
+ * reverse stuff for the expectations (see expectations.hpp)
  **********************************************************/
 
-//void BioGeoTree::prepare_stochmap_reverse_all_nodes(int from , int to){
-//	stochastic = true;
-//	int ndists = rootratemodel->getDists()->size();
-//
-//	//calculate and store local expectation matrix for each branch length
-//	//#pragma omp parallel for ordered num_threads(8)
-//	for(int k = 0; k < tree->getNodeCount(); k++){
-//		//cout << k << " " << tree->getNodeCount() << endl;
-//		vector<BranchSegment>* tsegs = tree->getNode(k)->getSegVector();
-//		for (unsigned int l = 0;l<tsegs->size();l++){
-//			int per = (*tsegs)[l].getPeriod();
-//			double dur =  (*tsegs)[l].getDuration();
-//			cx_mat eigvec(ndists,ndists);eigvec.fill(cx_double(0.0, 0.0));
-//			cx_mat eigval(ndists,ndists);eigval.fill(cx_double(0.0, 0.0));
-//			bool isImag = rootratemodel->get_eigenvec_eigenval_from_Q(&eigval, &eigvec,per);
-//			mat Ql(ndists,ndists);Ql.fill(0);Ql(from,to) = rootratemodel->get_Q()[per][from][to];
-//			mat W(ndists,ndists);W.fill(0);W(from,from) = 1;
-//			cx_mat summed(ndists,ndists);summed.fill(cx_double(0.0, 0.0));
-//			cx_mat summedR(ndists,ndists);summedR.fill(cx_double(0.0, 0.0));
-//			for(int i=0;i<ndists;i++){
-//				mat Ei(ndists,ndists);Ei.fill(0);Ei(i,i)=1;
-//				cx_mat Si(ndists,ndists);
-//				Si = eigvec * Ei * inv(eigvec);
-//				for(int j=0;j<ndists;j++){
-//					cx_double dij = (eigval(i,i)-eigval(j,j)) * dur;
-//					mat Ej(ndists,ndists);Ej.fill(0);Ej(j,j)=1;
-//					cx_mat Sj(ndists,ndists);
-//					Sj = eigvec * Ej * inv(eigvec);
-//					cx_double Iijt = 0;
-//					if (abs(dij) > 10){
-//						Iijt = (exp(eigval(i,i)*dur)-exp(eigval(j,j)*dur))/(eigval(i,i)-eigval(j,j));
-//					}else if(abs(dij) < 10e-20){
-//						Iijt = dur*exp(eigval(j,j)*dur)*(1.+dij/2.+pow(dij,2.)/6.+pow(dij,3.)/24.);
-//					}else{
-//						if(eigval(i,i) == eigval(j,j)){
-//							//WAS Iijt = dur*exp(eigval(j,j)*dur)*expm1(dij)/dij;
-//							if (isImag)
-//								Iijt = dur*exp(eigval(j,j)*dur)*(exp(dij)-1.)/dij;
-//							else
-//								Iijt = dur*exp(eigval(j,j)*dur)*(expm1(real(dij)))/dij;
-//						}else{
-//							//WAS Iijt = -dur*exp(eigval(i,i)*dur)*expm1(-dij)/dij;
-//							if (isImag)
-//								Iijt = -dur*exp(eigval(i,i)*dur)*(exp(-dij)-1.)/dij;
-//							else
-//								Iijt = -dur*exp(eigval(i,i)*dur)*(expm1(real(-dij)))/dij;
-//						}
-//					}
-//					summed += (Si  * Ql * Sj * Iijt);
-//					summedR += (Si * W * Sj * Iijt);
-//				}
-//			}
-//			stored_EN_matrices[per][dur] = (real(summed));
-//			stored_EN_CX_matrices[per][dur] = summed;
-//			stored_ER_matrices[per][dur] = (real(summedR));
-//			//for(int i=0;i<ndists;i++){
-//			//	for (int j=0;j<ndists;j++){
-//			//		if (real(summed(i,j)) < 0){
-//			//			cout <<"N:" <<  summed << endl;
-//			//			cout << endl;
-//			//			exit(0);
-//			//		}
-//			//		if (real(summedR(i,j)) < 0){
-//			//			cout <<"R:" << summedR << endl;
-//			//			cout << endl;
-//			//			exit(0);
-//			//		}
-//			//	}
-//			//}
-//		}
-//	}
-//}
-
 /*
- * called directly after reverse_stochastic
+ * the reverse pass over the whole tree, keeping the reverse conditionals
+ * at the top of every segment, those above the tips included
  */
+void BioGeoTree::prepare_expectations(){
+	stochastic = true;
+	prepare_ancstate_reverse();
+	stochastic = false;
+}
 
-vector<Superdouble> BioGeoTree::calculate_reverse_stochmap(Node & node,bool time){
-	if (node.isExternal()==false){//is not a tip
-		vector<BranchSegment> * tsegs = node.getSegVector();
-		vector<vector<int> > * dists = rootratemodel->getDists();
-		vector<Superdouble> totalExp (dists->size(),0);
-		for(int t = 0;t<tsegs->size();t++){
-			if (t == 0){
-				vector<Superdouble> Bs;
-				if(time)
-					Bs = tsegs->at(t).seg_sp_stoch_map_revB_time;
-				else
-					Bs =  tsegs->at(t).seg_sp_stoch_map_revB_number;
-				vector<int> leftdists;
-				vector<int> rightdists;
-				double weight;
-				Node * c1 = &node.getChild(0);
-				Node * c2 = &node.getChild(1);
-				vector<BranchSegment>* tsegs1 = c1->getSegVector();
-				vector<BranchSegment>* tsegs2 = c2->getSegVector();
-				vector<Superdouble> v1  =tsegs1->at(0).alphas;
-				vector<Superdouble> v2 = tsegs2->at(0).alphas;
-				vector<Superdouble> LHOODS (dists->size(),0);
-				for (unsigned int i = 0; i < dists->size(); i++) {
-					if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
-						vector<vector<int> > * exdist = node.getExclDistVector();
-						int cou = count(exdist->begin(), exdist->end(), dists->at(i));
-						if (cou == 0) {
-							iter_ancsplits_just_int(rootratemodel, dists->at(i),leftdists, rightdists, weight, node.getPeriod());
-							for (unsigned int j=0;j<leftdists.size();j++){
-								int ind1 = leftdists[j];
-								int ind2 = rightdists[j];
-								LHOODS[i] += (v1.at(ind1)*v2.at(ind2)*weight);
-							}
-							LHOODS[i] *= Bs.at(i);
-						}
-					}
-				}
-				for(int i=0;i<dists->size();i++){
-					totalExp[i] = LHOODS[i];
-				}
-			}else{
-				vector<Superdouble> alphs = tsegs->at(t-1).seg_sp_alphas;
-				vector<Superdouble> Bs;
-				if(time)
-					Bs = tsegs->at(t).seg_sp_stoch_map_revB_time;
-				else
-					Bs =  tsegs->at(t).seg_sp_stoch_map_revB_number;
-				vector<Superdouble> LHOODS (dists->size(),0);
-				for (unsigned int i = 0; i < dists->size(); i++) {
-					if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
-						vector<vector<int> > * exdist = node.getExclDistVector();
-						int cou = count(exdist->begin(), exdist->end(), dists->at(i));
-						if (cou == 0) {
-							LHOODS[i] = Bs.at(i) * (alphs[i] );//do i do this or do i do from i to j
-						}
-					}
-				}
-				for(int i=0;i<dists->size();i++){
-					totalExp[i] += LHOODS[i];
-				}
-			}
-		}
-		//not sure if this should return a Superdouble or not when doing a bigtree
-		return totalExp;
-	}else{
-		vector<BranchSegment> * tsegs = node.getSegVector();
-		vector<vector<int> > * dists = rootratemodel->getDists();
-		vector<Superdouble> totalExp (dists->size(),0);
-		for(int t = 0;t<tsegs->size();t++){
-			if(t == 0){
-				vector<Superdouble> Bs;
-				if(time)
-					Bs = tsegs->at(t).seg_sp_stoch_map_revB_time;
-				else
-					Bs =  tsegs->at(t).seg_sp_stoch_map_revB_number;
-				vector<Superdouble> LHOODS (dists->size(),0);
-				for (unsigned int i = 0; i < dists->size(); i++) {
-					if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
-						vector<vector<int> > * exdist = node.getExclDistVector();
-						int cou = count(exdist->begin(), exdist->end(), dists->at(i));
-						if (cou == 0) {
-							LHOODS[i] = Bs.at(i) * (tsegs->at(0).distconds->at(i) );
-						}
-					}
-				}
-				for(int i=0;i<dists->size();i++){
-					totalExp[i] = LHOODS[i];
-				}
-			}else{
-				vector<Superdouble> alphs = tsegs->at(t-1).seg_sp_alphas;
-				vector<Superdouble> Bs;
-				if(time)
-					Bs = tsegs->at(t).seg_sp_stoch_map_revB_time;
-				else
-					Bs =  tsegs->at(t).seg_sp_stoch_map_revB_number;
-				vector<Superdouble> LHOODS (dists->size(),0);
-				for (unsigned int i = 0; i < dists->size(); i++) {
-					if (accumulate(dists->at(i).begin(), dists->at(i).end(), 0) > 0) {
-						vector<vector<int> > * exdist = node.getExclDistVector();
-						int cou = count(exdist->begin(), exdist->end(), dists->at(i));
-						if (cou == 0) {
-							LHOODS[i] = Bs.at(i) * (alphs[i]);
-						}
-					}
-				}
-				for(int i=0;i<dists->size();i++){
-					totalExp[i] += LHOODS[i];
-				}
-			}
-		}
-		return totalExp;
-	}
+/*
+ * the reverse conditionals at the top of segment seg of the branch above node
+ * (the probability of everything outside the subtree below, given each range),
+ * as doubles relative to the largest one, after prepare_expectations
+ */
+vector<double> BioGeoTree::relative_reverse(Node & node, unsigned int seg){
+	return dispatch([&](auto zero){
+		typedef decltype(zero) Scalar;
+		return to_relative(node.getSegVector()->at(seg).conds<Scalar>().seg_sp_revA);
+	});
 }
 
 /**********************************************************
@@ -1237,23 +1128,29 @@ vector<Superdouble> BioGeoTree::calculate_reverse_stochmap(Node & node,bool time
 BioGeoTree::~BioGeoTree(){
 	for(int i=0;i<tree->getNodeCount();i++){
 		vector<BranchSegment> * tsegs = tree->getNode(i)->getSegVector();
-		for(unsigned int j=0;j<tsegs->size();j++){
-			delete tsegs->at(j).distconds;
-			delete tsegs->at(j).ancdistconds;
-		}
+		dispatch([&](auto zero){
+			for(unsigned int j=0;j<tsegs->size();j++){
+				delete tsegs->at(j).conds<decltype(zero)>().distconds;
+				delete tsegs->at(j).conds<decltype(zero)>().ancdistconds;
+			}
+		});
 		tree->getNode(i)->deleteExclDistVector();
 		if(rev == true && tree->getNode(i)->isInternal()){
 			tree->getNode(i)->deleteDoubleVector(revB);
 		}
-		if(sim == true){
-			delete tree->getNode(i)->getObject("simstate");
-		}
 		tree->getNode(i)->deleteSegVector();
 	}
 	tree->getRoot()->deleteDoubleVector(dc);
 	tree->getRoot()->deleteDoubleVector(andc);
 	tree->getRoot()->deleteDoubleVector(revB);
-
-	gsl_rng_free (r);
 }
 
+template vector<Superdouble> BioGeoTree::conditionals<Superdouble>(Node &, bool, bool);
+template vector<long double> BioGeoTree::conditionals<long double>(Node &, bool, bool);
+template vector<double> BioGeoTree::conditionals<double>(Node &, bool, bool);
+template bool BioGeoTree::ancdist_conditional_lh<Superdouble>(Node &, bool);
+template bool BioGeoTree::ancdist_conditional_lh<long double>(Node &, bool);
+template bool BioGeoTree::ancdist_conditional_lh<double>(Node &, bool);
+template void BioGeoTree::reverse<Superdouble>(Node &, const set<Node *> *);
+template void BioGeoTree::reverse<long double>(Node &, const set<Node *> *);
+template void BioGeoTree::reverse<double>(Node &, const set<Node *> *);
@@ -11,6 +11,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
 using namespace std;
 
 #include "RateModel.h"
@@ -20,8 +21,7 @@ using namespace std;
 #include "node.h"
 #include "vector_node_object.h"
 #include "BioGeoTreeTools.h"
-#include <gsl/gsl_rng.h>
-#include <gsl/gsl_randist.h>
+#include "scalar.hpp"
 
 //#include <armadillo>
 //using namespace arma;
@@ -34,6 +34,14 @@ class BioGeoTree{
 private:
 	Tree * tree;
 	vector<double> periods;
+	/*
+	 * numeric type of the conditionals, fixed for the life of the tree:
+	 * the kernels below are templates over it, instantiated for each type
+	 * of scalar.hpp, and results leave as Superdouble whatever the type
+	 */
+	scalar::Type scalar_type;
+	template <typename F>
+	auto dispatch(F f);
 	string age;
 	string dc;
 	string en;
@@ -44,6 +52,22 @@ private:
 	map<int, vector<int> > * distmap; // a map of int and dist
 	bool store_p_matrices;
 	bool use_stored_matrices;
+	/*
+	 * columns of P for the segments starting from a single range (the tips),
+	 * shared within one likelihood evaluation
+	 * map<period,map<duration,map<range position,column> > >
+	 */
+	map<int,map<double,map<int,vector<double> > > > p_columns;
+	/*
+	 * incremental evaluation: the Q versions of each period as of the last
+	 * likelihood evaluation, from which the periods changed since then
+	 * (all of them if full_update), and so the branches to recompute
+	 */
+	RateModel * evaluated_model;
+	vector<unsigned long> evaluated_versions;
+	vector<bool> dirty_periods;
+	bool full_update;
+	bool branch_changed(Node & node);
 	bool ultrametric;	//	is false when at least one of the input trees is non-ultrametric
 	BioGeoTreeTools tt;
 
@@ -52,15 +76,6 @@ private:
 	bool rev;
 	//end reverse bits
 
-	//simulate bits
-	bool sim;
-	double sim_D;
-	double sim_E;
-
-	const gsl_rng_type * T;
-	gsl_rng * r;
-	unsigned long int ran_seed;
-	//end simulate bits
 
 	//estimate bits
 	bool readSimStates;
@@ -69,15 +84,10 @@ private:
 	double true_E;
 	//end estimate bits
 
-	//stochastic mapping bits
-	string rev_exp_number;
-	string rev_exp_time;
+	//expectations bits
+	//the reverse pass then keeps the reverse conditionals of every segment
 	bool stochastic;
-	//map of period int and then branch length Superdouble
-//	map<int,map<double, mat > > stored_EN_matrices;
-//	map<int,map<double,cx_mat> > stored_EN_CX_matrices;
-//	map<int,map<double, mat > > stored_ER_matrices;
-	//end mapping bits
+	//end expectations bits
 
 	/*
 	 * benchmark variables
@@ -91,7 +101,7 @@ private:
 
 public:
 //	BioGeoTree() {};
-	BioGeoTree(Tree * tr, vector<double> ps);
+	BioGeoTree(Tree * tr, vector<double> ps, scalar::Type st = scalar::Type::Superdouble);
 	void set_store_p_matrices(bool);
 	void set_use_stored_matrices(bool);
 	void print_segs();
@@ -101,9 +111,11 @@ public:
 	void set_excluded_dist(vector<int> ind,Node * node);
 	void set_tip_conditionals(map<string,vector<int> > distrib_data);
 	void set_node_constraints(vector<vector<vector<int> > > exdists_per_period, map<int,string> areanamemaprev);
-	vector<Superdouble> conditionals(Node & node, bool marg, bool sparse);
+	template <typename Scalar>
+	vector<Scalar> conditionals(Node & node, bool marg, bool sparse);
 	//void ancdist_conditional_lh(bpp::Node & node, bool marg);
-	void ancdist_conditional_lh(Node & node, bool marg);
+	template <typename Scalar>
+	bool ancdist_conditional_lh(Node & node, bool marg);
 	void set_ultrametric(bool ultMet);
 
 /*
@@ -119,19 +131,31 @@ public:
 	for calculating forward and reverse
  */
 	void prepare_ancstate_reverse();
-	void reverse(Node &);
-	map<vector<int>,vector<AncSplit> > calculate_ancsplit_reverse(Node & node,bool marg);
+	void prepare_ancstate_reverse(const vector<Node *> & nodes);
+	template <typename Scalar>
+	void reverse(Node &, const set<Node *> * path = NULL);
+	vector<Superdouble> calculate_ancsplit_reverse(Node & node,bool marg);
+	template <typename Scalar>
+	vector<Superdouble> calculate_ancsplit_reverse(Node & node,bool marg);
 	vector<Superdouble> calculate_ancstate_reverse(Node & node,bool marg);
+	template <typename Scalar>
+	vector<Scalar> calculate_ancstate_reverse(Node & node,bool marg);
 /*
-	for forward simulations
+	for stochastic mapping (see stochastic_mapping.hpp)
+ */
+	vector<double> relative_conditionals(Node & node, unsigned int seg);
+/*
+	for the expectations (see expectations.hpp)
+ */
+	void prepare_expectations();
+	vector<double> relative_reverse(Node & node, unsigned int seg);
+/*
+	for the root-range profile (see root_profile.hpp)
+ */
+	vector<Superdouble> root_conditionals();
+/*
+	for datasets simulated beforehand (see simulation.hpp)
  */
-	void prepare_simulation(unsigned long int seed, bool ranPar);
-	void simulate(Node & node);
-	double getSim_D();
-	double getSim_E();
-	void setSim_D(const double disp);
-	void setSim_E(const double ext);
-
 	void read_true_states(string truestatesfile);
 	vector<int> * get_true_state(int num);
 	double getTrue_D();
@@ -142,14 +166,6 @@ public:
 //	BioGeoTree(const BioGeoTree &L);             // copy constructor
 //    BioGeoTree & operator=(const BioGeoTree &L);
 
-/*
- * for calculating forward and reverse for expected values (stochastic mapping)
- */
-//	void prepare_stochmap_reverse_all_nodes(int, int);
-	vector<Superdouble> calculate_reverse_stochmap(Node &, bool);
-	vector<Superdouble> calculate_reverse_stochmap_TEST(Node & node,bool time);
-
-
 /*
 	for timing things
  */
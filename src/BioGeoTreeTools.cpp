@@ -38,104 +38,93 @@ vector<Node *> BioGeoTreeTools::getAncestors(Tree & tree, Node & nodeId){
     return nodes;
 }
 
-void BioGeoTreeTools::summarizeSplits(Node * node,map<vector<int>,vector<AncSplit> > & ans,map<int,string> &areanamemaprev, RateModel * rm){
-	Superdouble best(0);
-	Superdouble sum(0);
-	map<Superdouble,string > printstring;
-	int areasize = (*ans.begin()).first.size();
-	map<int, vector<int> > * distmap = rm->get_int_dists_map();
-	vector<int> bestldist;
-	vector<int> bestrdist;
-	map<vector<int>,vector<AncSplit> >::iterator it;
-	bool first = true;
-	Superdouble zero(0);
-	for(it=ans.begin();it!=ans.end();it++){
-		vector<int> dis = (*it).first;
-		vector<AncSplit> tans = (*it).second;
-		for (unsigned int i=0;i<tans.size();i++){
-			if (tans[i].getLikelihood() != zero) {
-				if (first == true){
-					first = false;
-					best = tans[i].getLikelihood();
-					bestldist = (*distmap)[tans[i].ldescdistint];//tans[i].getLDescDist();
-					bestrdist = (*distmap)[tans[i].rdescdistint];//tans[i].getRDescDist();
-				}else if (tans[i].getLikelihood() > best){
-					best = tans[i].getLikelihood();
-					bestldist = (*distmap)[tans[i].ldescdistint];//tans[i].getLDescDist();
-					bestrdist = (*distmap)[tans[i].rdescdistint];//tans[i].getRDescDist();
-				}
-				//cout << -log(tans[i].getLikelihood()) << endl;
-				sum += tans[i].getLikelihood();
-			}
-		}
-	}
-	Superdouble test2(2);
-	for(it=ans.begin();it!=ans.end();it++){
-		vector<int> dis = (*it).first;
-		vector<AncSplit> tans = (*it).second;
-		for (unsigned int i=0;i<tans.size();i++){
-			if ((tans[i].getLikelihood() != zero) && ((best.getLn()-(tans[i].getLikelihood().getLn())) < test2)){
-				string tdisstring ="";
-				int  count1 = 0;
-				for(int m=0;m<areasize;
-						//tans[i].getLDescDist().size();
-						m++){
-					//if(tans[i].getLDescDist()[m] == 1){
-					if((*distmap)[tans[i].ldescdistint][m] == 1){
-						tdisstring += areanamemaprev[m];
-						count1 += 1;
-						if(count1 < calculate_vector_int_sum(&(*distmap)[tans[i].ldescdistint])){
-							tdisstring += "_";
-						}
-					}
-
-				}tdisstring += "|";
-				count1 = 0;
-				for(int m=0;m<areasize;
-						//tans[i].getRDescDist().size();
-						m++){
-					if((*distmap)[tans[i].rdescdistint][m] == 1){
-						tdisstring += areanamemaprev[m];
-						count1 += 1;
-						if(count1 < calculate_vector_int_sum(&(*distmap)[tans[i].rdescdistint])){
-							tdisstring += "_";
-						}
-					}
-				}
-				printstring[tans[i].getLikelihood()] = tdisstring;
-			}
-		}
-	}
-	Superdouble none(-1);
-	map<Superdouble,string >::reverse_iterator pit;
-	for(pit=printstring.rbegin();pit != printstring.rend();pit++){
-		Superdouble lnl(((*pit).first));
-		cout << "\t" << (*pit).second << "\t" << double(lnl/sum) << "\t(" << double(none*lnl.getLn())<< ")"<< endl;
-	}
-	StringNodeObject disstring ="";
-	int  count = 0;
-	for(unsigned int m=0;m<bestldist.size();m++){
-		if(bestldist[m] == 1){
+/*
+ * area names of the split, as in "A_B|C"
+ */
+static string split_string(vector<int> & ldist,vector<int> & rdist,map<int,string> &areanamemaprev){
+	string disstring ="";
+	int count = 0;
+	for(unsigned int m=0;m<ldist.size();m++){
+		if(ldist[m] == 1){
 			disstring += areanamemaprev[m];
 			count += 1;
-			//if(count < calculate_vector_int_sum(&bestldist))
-			if(count < accumulate(bestldist.begin(),bestldist.end(),0))
+			if(count < accumulate(ldist.begin(),ldist.end(),0))
 				disstring += "_";
 		}
 	}disstring += "|";
 	count = 0;
-	for(unsigned int m=0;m<bestrdist.size();m++){
-		if(bestrdist[m] == 1){
+	for(unsigned int m=0;m<rdist.size();m++){
+		if(rdist[m] == 1){
 			disstring += areanamemaprev[m];
 			count += 1;
-			//if(count < calculate_vector_int_sum(&bestrdist))
-			if(count < accumulate(bestrdist.begin(),bestrdist.end(),0))
+			if(count < accumulate(rdist.begin(),rdist.end(),0))
 				disstring += "_";
 		}
 	}
+	return disstring;
+}
+
+/*
+ * ans holds the likelihood of every split of the flat table of the node's period
+ * (see BioGeoTree::calculate_ancsplit_reverse)
+ * splits are visited range by range in the order of their areas,
+ * which is how they have always been summed, reported and told apart when tied
+ */
+void BioGeoTreeTools::summarizeSplits(Node * node,vector<Superdouble> & ans,map<int,string> &areanamemaprev, RateModel * rm){
+	const cladogenesis::Splits & splits = rm->get_splits_per_period(node->getPeriod());
+	vector<vector<int> > * distmap = rm->getDists();
+	vector<int> ranges(distmap->size());
+	for(unsigned int j=0;j<ranges.size();j++)
+		ranges[j] = j;
+	sort(ranges.begin(),ranges.end(),[&](int a,int b){return (*distmap)[a] < (*distmap)[b];});
+	vector<int> order;
+	order.reserve(ans.size());
+	for(unsigned int j=0;j<ranges.size();j++)
+		for(int k=splits.first(ranges[j]);k<splits.first(ranges[j])+splits.n_splits(ranges[j]);k++)
+			order.push_back(k);
+
+	Superdouble best(0);
+	Superdouble sum(0);
+	int bestsplit = -1;
+	Superdouble zero(0);
+	for(unsigned int i=0;i<order.size();i++){
+		Superdouble & lh = ans[order[i]];
+		if (lh != zero) {
+			if (bestsplit == -1 || lh > best){
+				best = lh;
+				bestsplit = order[i];
+			}
+			sum += lh;
+		}
+	}
 	string spl = "split";
+	if (bestsplit == -1){
+		StringNodeObject disstring = "|";
+		node->assocObject(spl,disstring);
+		return;
+	}
+
+	/*
+	 * splits within 2 log-units of the best, most likely first;
+	 * of those tied, only the last visited is reported
+	 */
+	Superdouble test2(2);
+	Superdouble bestln = best.getLn();
+	vector<int>::iterator kept = stable_partition(order.begin(),order.end(),[&](int k){
+		Superdouble lh = ans[k];
+		return lh != zero && (bestln-lh.getLn()) < test2;
+	});
+	stable_sort(order.begin(),kept,[&](int a,int b){return ans[b] < ans[a];});
+	Superdouble none(-1);
+	for(vector<int>::iterator it=order.begin();it!=kept;it++){
+		if (it+1 != kept && !(ans[*(it+1)] < ans[*it]))
+			continue;
+		Superdouble lnl(ans[*it]);
+		string tdisstring = split_string((*distmap)[splits.left_of(*it)],(*distmap)[splits.right_of(*it)],areanamemaprev);
+		cout << "\t" << tdisstring << "\t" << double(lnl/sum) << "\t(" << double(none*lnl.getLn())<< ")"<< endl;
+	}
+	StringNodeObject disstring = split_string((*distmap)[splits.left_of(bestsplit)],(*distmap)[splits.right_of(bestsplit)],areanamemaprev);
 	node->assocObject(spl,disstring);
-	//cout << -log(best) << " "<< best/sum << endl;
 }
 
 
@@ -144,7 +133,7 @@ void BioGeoTreeTools::summarizeAncState(Node * node,vector<Superdouble> & ans,ma
 	Superdouble sum(0);
 	map<Superdouble,string > printstring;
 	int areasize = rm->get_num_areas();
-	map<int, vector<int> > * distmap = rm->get_int_dists_map();
+	vector<vector<int> > * distmap = rm->getDists();
 	vector<int> bestancdist;
 	int bestdistindex = 0;
 	Superdouble zero(0);
@@ -215,7 +204,7 @@ void BioGeoTreeTools::summarizeAncState(Node * node,vector<Superdouble> & ans,ma
 }
 
 string BioGeoTreeTools::get_string_from_dist_int(int dist,map<int,string> &areanamemaprev, RateModel * rm){
-    map<int, vector<int> > * distmap = rm->get_int_dists_map();
+    vector<vector<int> > * distmap = rm->getDists();
     vector<int> bestancdist = (*distmap)[dist];
 
     StringNodeObject disstring ="";
@@ -231,35 +220,3 @@ string BioGeoTreeTools::get_string_from_dist_int(int dist,map<int,string> &arean
     }
     return disstring;
 }
-
-void BioGeoTreeTools::summarizeSimState(Node & node,vector<Superdouble> & ans,RateModel * rm)
-{
-//	cout << "\nnodenum : " << node.getNumber() << endl;
-//	for (unsigned int i = 0; i < ans.size(); i++)
-//		cout << ans[i] << " ";
-//	cout << endl;
-
-	Superdouble best(ans[1]);//use ans[1] because ans[0] is just 0
-	map<int, vector<int> > * distmap = rm->get_int_dists_map();
-	vector<int> bestdist;
-	int bestdistindex = 0;
-	Superdouble zero(0);
-	for (unsigned int i = 1; i < ans.size(); i++) { //1 because 0 is just the 0 all extinct one
-		if (ans[i] >= best && ans[i] != zero) { //added != 0, need to test
-			best = ans[i];
-			bestdist = (*distmap)[i];
-			bestdistindex = i;
-		}
-	}
-
-	StringNodeObject disstring(print_area_vector(bestdist,*rm->get_areanamemaprev()));
-	node.assocObject("simstate",disstring);
-	node.setIntObject("simdistidx",bestdistindex);
-
-//	if (node.isInternal())
-//		cout << node.getNumber() << "\t" << *((StringNodeObject*) (node.getObject("simstate"))) << endl;
-//	else
-//		cout << node.getName() << "\t" << *((StringNodeObject*) (node.getObject("simstate"))) << endl;
-//	cout << "dist : " << print_area_vector(bestancdist,*rm->get_areanamemaprev()) << " (" << bestancindex << ")" << endl;
-}
-
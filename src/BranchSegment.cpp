@@ -14,7 +14,7 @@ using namespace std;
 
 BranchSegment::BranchSegment(double dur,int per):duration(dur),period(per),
 		model(NULL),fossilareaindices(vector<int>()),startdistint(-666),
-		distconds(NULL),ancdistconds(NULL),isFossil(false),isTipFossil(false){}
+		isFossil(false),isTipFossil(false){}
 
 void BranchSegment::setModel(RateModel * mod){
 	model = mod;
@@ -14,10 +14,21 @@ using namespace std;
 #include "RateModel.h"
 
 #include "vector_node_object.h"
-#include "superdouble.h"
-#ifdef XYZ
-#include "gmpfrxx/gmpfrxx.h"
-#endif
+#include "scalar.hpp"
+
+/*
+ * conditionals along a segment, for one of the numeric types
+ * the likelihood engine runs with (see scalar.hpp)
+ */
+template <typename Scalar>
+struct SegmentConditionals{
+	SegmentConditionals():distconds(NULL),ancdistconds(NULL){}
+	vector<Scalar> * distconds;
+	vector<Scalar> alphas; // alpha for the entire branch -- stored in the 0th segment for anc calc
+	vector<Scalar> seg_sp_alphas; // alpha for this specific segment, stored for the stoch map
+	vector<Scalar> seg_sp_revA; // reverse conditionals at the top of this specific segment, stored for the expectations
+	vector<Scalar> * ancdistconds;//for ancestral state reconstructions
+};
 
 class BranchSegment{
 	private:
@@ -42,21 +53,9 @@ class BranchSegment{
 		RateModel * getModel();
 		vector<int> getFossilAreas();
 		void setFossilArea(int area);
-#ifdef XYZ
-		VectorNodeObject<mpfr_class> * distconds;
-		VectorNodeObject<mpfr_class> alphas;
-		VectorNodeObject<mpfr_class> * ancdistconds;//for ancestral state reconstructions
-		VectorNodeObject<mpfr_class> seg_sp_alphas;
-		VectorNodeObject<mpfr_class> seg_sp_stoch_map_revB_time;
-		VectorNodeObject<mpfr_class> seg_sp_stoch_map_revB_number;
-#else
-		vector<Superdouble> * distconds;
-		vector<Superdouble> alphas; // alpha for the entire branch -- stored in the 0th segment for anc calc
-		vector<Superdouble> seg_sp_alphas; // alpha for this specific segment, stored for the stoch map
-		vector<Superdouble> seg_sp_stoch_map_revB_time; //segment specific rev B, combining the tempA and the ENLT
-		vector<Superdouble> seg_sp_stoch_map_revB_number; //segment specific rev B, combining the tempA and the ENLT
-		vector<Superdouble> * ancdistconds;//for ancestral state reconstructions
-#endif
+		scalar::PerType<SegmentConditionals> conditionals;
+		template <typename Scalar>
+		SegmentConditionals<Scalar> & conds(){return get<SegmentConditionals<Scalar> >(conditionals);}
 };
 
 #endif /* BRANCHSEGMENT_H_ */
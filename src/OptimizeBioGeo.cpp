@@ -18,7 +18,8 @@ using namespace std;
 #include <gsl/gsl_vector.h>
 
 OptimizeBioGeo::OptimizeBioGeo(BioGeoTree * intree,RateModel * inrm, bool marg, int maxiter, double stopprec):
-	tree(intree), rm(inrm), maxiterations(maxiter),stoppingprecision(stopprec),marginal(marg){}
+	tree(intree), rm(inrm), maxiterations(maxiter),stoppingprecision(stopprec),marginal(marg),
+	per_period(false),probe(NULL){}
 
 double OptimizeBioGeo::GetLikelihoodWithOptimizedDispersalExtinction(const gsl_vector * variables)
 {
@@ -120,3 +121,140 @@ vector<double> OptimizeBioGeo::optimize_global_dispersal_extinction(double start
 	//cout << "dis: " << results[0] << " ext: " << results[1] << endl;
 	return results;
 }
+
+/*
+ * the rates are optimized unconstrained through a logistic map onto
+ * (0, MAX_RATE): close to the log of the rate, far from the upper bound
+ */
+static const double MAX_RATE = 100;
+
+static double to_rate(double variable){
+	return MAX_RATE / (1 + exp(-variable));
+}
+
+static double from_rate(double rate){
+	return log(rate / (MAX_RATE - rate));
+}
+
+/*
+ * rates given in the layout of optimize_rates
+ */
+void OptimizeBioGeo::set_rates(const vector<double> & rates){
+	int nperiods = rm->get_num_periods();
+	int nrates = per_period ? nperiods : 1;
+	for (unsigned int i=0;i<free_cells.size();i++){
+		const FreeDmaskCell & cell = free_cells[i];
+		rm->set_Dmask_cell(cell.period,cell.from,cell.to,rates[2*nrates+i],false);
+	}
+	for (int p=0;p<nperiods;p++){
+		int r = per_period ? p : 0;
+		rm->set_D_period(p,rates[r]);
+		rm->set_E_period(p,rates[nrates+r]);
+	}
+	rm->setup_Q_with_adjacency();
+}
+
+double OptimizeBioGeo::GetLikelihoodWithRates(const gsl_vector * variables)
+{
+	vector<double> rates(variables->size);
+	for (unsigned int i=0;i<rates.size();i++)
+		rates[i] = to_rate(gsl_vector_get(variables,i));
+	set_rates(rates);
+	tree->update_default_model(rm);
+	double like = tree->eval_likelihood(marginal);
+	if(like < 0 || like == std::numeric_limits<double>::infinity())
+		like = 100000000;
+	return like;
+}
+
+/*
+ * forward differences: each probe moves a single rate,
+ * so only the branches within its period(s) are recomputed
+ */
+void OptimizeBioGeo::GetLikelihoodGradient(const gsl_vector * variables, double like, gsl_vector * gradient)
+{
+	const double h = 1e-5;
+	gsl_vector_memcpy(probe,variables);
+	for (unsigned int i=0;i<variables->size;i++){
+		double x = gsl_vector_get(variables,i);
+		double moved = x + h;
+		gsl_vector_set(probe,i,moved);
+		gsl_vector_set(gradient,i,(GetLikelihoodWithRates(probe) - like) / (moved - x));
+		gsl_vector_set(probe,i,x);
+	}
+}
+
+double OptimizeBioGeo::GetLikelihoodWithRates_gsl(const gsl_vector * variables, void *obj)
+{
+	return ((OptimizeBioGeo*)obj)->GetLikelihoodWithRates(variables);
+}
+
+void OptimizeBioGeo::GetLikelihoodGradient_gsl(const gsl_vector * variables, void *obj, gsl_vector * gradient)
+{
+	OptimizeBioGeo * pt = (OptimizeBioGeo*)obj;
+	pt->GetLikelihoodGradient(variables,pt->GetLikelihoodWithRates(variables),gradient);
+}
+
+void OptimizeBioGeo::GetLikelihoodAndGradient_gsl(const gsl_vector * variables, void *obj, double * like, gsl_vector * gradient)
+{
+	OptimizeBioGeo * pt = (OptimizeBioGeo*)obj;
+	*like = pt->GetLikelihoodWithRates(variables);
+	pt->GetLikelihoodGradient(variables,*like,gradient);
+}
+
+/*
+ * USES BFGS ON THE (BOUNDED) LOG OF THE RATES
+ * for the dispersal and extinction rates of every period
+ * and the free cells of the dispersal mask, too many for the simplex
+ */
+vector<double> OptimizeBioGeo::optimize_rates(bool perperiod, const vector<FreeDmaskCell> & freecells, double startDisp, double startExt){
+	per_period = perperiod;
+	free_cells = freecells;
+	size_t nrates = per_period ? rm->get_num_periods() : 1;
+	size_t np = 2*nrates + free_cells.size();
+	size_t iter = 0;
+	int status;
+	/* Starting point, the free cells at 1 */
+	gsl_vector *x = gsl_vector_alloc (np);
+	gsl_vector_set_all (x, from_rate(1));
+	for (size_t i=0;i<nrates;i++){
+		gsl_vector_set (x,i,from_rate(startDisp));
+		gsl_vector_set (x,nrates+i,from_rate(startExt));
+	}
+	probe = gsl_vector_alloc (np);
+	gsl_multimin_function_fdf func;
+	func.f = &OptimizeBioGeo::GetLikelihoodWithRates_gsl;
+	func.df = &OptimizeBioGeo::GetLikelihoodGradient_gsl;
+	func.fdf = &OptimizeBioGeo::GetLikelihoodAndGradient_gsl;
+	func.n = np;
+	func.params = this;
+	gsl_multimin_fdfminimizer *s = gsl_multimin_fdfminimizer_alloc (gsl_multimin_fdfminimizer_vector_bfgs2, np);
+	gsl_multimin_fdfminimizer_set (s, &func, x, 0.1, 0.1);
+	do
+	{
+		iter++;
+		status = gsl_multimin_fdfminimizer_iterate(s);
+		if (status == GSL_ENOPROG) //no better point along the search direction
+			break;
+		if (status!=0) {
+			printf ("error: %s\n", gsl_strerror (status));
+			break;
+		}
+		status = gsl_multimin_test_gradient (s->gradient, stoppingprecision);
+	}
+	while (status == GSL_CONTINUE && iter < maxiterations);
+	if (status == GSL_CONTINUE && iter == maxiterations) {
+		cout << "\nAttained the maximum number of iterations: " << maxiterations << endl
+			 << "Please rerun Lagrange having increased the maximum number of iterations"
+				"\nor reduce the \"stoppingprecision\" (currently at " << stoppingprecision << ") of the optimisation step." << endl;
+		exit(-1);
+	}
+	vector<double> results;
+	for (size_t i=0;i<np;i++)
+		results.push_back(to_rate(gsl_vector_get(s->x,i)));
+	gsl_vector_free(x);
+	gsl_vector_free(probe);
+	probe = NULL;
+	gsl_multimin_fdfminimizer_free (s);
+	return results;
+}
@@ -16,6 +16,16 @@ using namespace std;
 
 #include <gsl/gsl_vector.h>
 
+/*
+ * a cell of the dispersal mask left free ('?') in the rates file,
+ * estimated along with the rates
+ */
+struct FreeDmaskCell{
+	int period;
+	int from;
+	int to;
+};
+
 class OptimizeBioGeo{
 	private:
 		BioGeoTree * tree;
@@ -25,10 +35,27 @@ class OptimizeBioGeo{
 		bool marginal;
 		double GetLikelihoodWithOptimizedDispersalExtinction(const gsl_vector * variables);
 		static double GetLikelihoodWithOptimizedDispersalExtinction_gsl(const gsl_vector * variables, void *obj);
+		/*
+		 * gradient-based estimation, on the bounded log of the rates
+		 */
+		bool per_period;
+		vector<FreeDmaskCell> free_cells;
+		gsl_vector * probe;
+		double GetLikelihoodWithRates(const gsl_vector * variables);
+		void GetLikelihoodGradient(const gsl_vector * variables, double like, gsl_vector * gradient);
+		static double GetLikelihoodWithRates_gsl(const gsl_vector * variables, void *obj);
+		static void GetLikelihoodGradient_gsl(const gsl_vector * variables, void *obj, gsl_vector * gradient);
+		static void GetLikelihoodAndGradient_gsl(const gsl_vector * variables, void *obj, double * like, gsl_vector * gradient);
 
 	public:
 		OptimizeBioGeo(BioGeoTree * intree,RateModel * inrm, bool marg, int maxiter, double stopprec);
 		vector<double> optimize_global_dispersal_extinction(double startDisp, double startExt);
+		/*
+		 * rates are laid out as the dispersal then the extinction rates
+		 * (one each, or one per period), then the free cells in the given order
+		 */
+		vector<double> optimize_rates(bool perperiod, const vector<FreeDmaskCell> & freecells, double startDisp, double startExt);
+		void set_rates(const vector<double> & rates);
 
 
 };
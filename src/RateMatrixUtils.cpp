@@ -21,22 +21,6 @@
 #include <algorithm>
 using namespace std;
 
-#ifdef XYZ
-#include "gmpfrxx/gmpfrxx.h"
-#endif
-
-
-#ifdef XYZ
-double calculate_vector_mpfr_class_double_sum(vector<mpfr_class> & in){
-	double sum = 0;
-	for (unsigned int i=0;i<in.size();i++){
-		double x = in[i].get_d();
-		sum += x;
-	}
-	return sum;
-}
-#endif
-
 double calculate_vector_double_sum(vector<double> & in){
 	double sum = 0;
 	for (unsigned int i=0;i<in.size();i++){
@@ -55,6 +39,22 @@ Superdouble calculate_vector_Superdouble_sum(vector<Superdouble> & in){
 	return sum;
 }
 
+/*
+ * the same for any of the numeric types of the likelihood engine
+ */
+template <typename Scalar>
+Scalar calculate_vector_scalar_sum(vector<Scalar> & in){
+	Scalar sum = 0;
+	for (unsigned int i=0;i<in.size();i++){
+		sum += in[i];
+	}
+	return sum;
+}
+
+template Superdouble calculate_vector_scalar_sum(vector<Superdouble> &);
+template long double calculate_vector_scalar_sum(vector<long double> &);
+template double calculate_vector_scalar_sum(vector<double> &);
+
 
 /*
  * only used because sometimes will send a null
@@ -157,34 +157,19 @@ vector<AncSplit> iter_ancsplits(RateModel *rm, vector<int> & dist, int period){
 	vector<AncSplit> ans;
 //	vector<vector<vector<int> > > * splits = rm->get_iter_dist_splits(dist);
 	vector<vector<vector<int> > > * splits = rm->get_iter_dist_splits_per_period(dist, period);
-	map<vector<int>,int> * distsmap = rm->get_dists_int_map();
 	if(splits->at(0).size()>0){
 		int nsplits = splits->at(0).size();
 		double weight = 1.0/nsplits;
+		int distint = rm->get_dist_int(dist);
 		for (unsigned int i=0;i<splits->at(0).size();i++){
 			//AncSplit an(rm,dist,splits->at(0)[i],splits->at(1)[i],weight);
-			AncSplit an(rm,(*distsmap)[dist],(*distsmap)[splits->at(0)[i]],(*distsmap)[splits->at(1)[i]],weight);
+			AncSplit an(rm,distint,rm->get_dist_int(splits->at(0)[i]),rm->get_dist_int(splits->at(1)[i]),weight);
 			ans.push_back(an);
 		}
 	}
 	return ans;
 }
 
-void iter_ancsplits_just_int(RateModel *rm, vector<int> & dist,vector<int> & leftdists, vector<int> & rightdists, double & weight, int period){
-	leftdists.clear();rightdists.clear();weight=0;
-	//	vector<vector<vector<int> > > * splits = rm->get_iter_dist_splits(dist);
-		vector<vector<vector<int> > > * splits = rm->get_iter_dist_splits_per_period(dist, period);
-	map<vector<int>,int> * distsmap = rm->get_dists_int_map();
-	if(splits->at(0).size()>0){
-		int nsplits = splits->at(0).size();
-		weight = 1.0/nsplits;
-		for (unsigned int i=0;i<splits->at(0).size();i++){
-			leftdists.push_back((*distsmap)[splits->at(0)[i]]);
-			rightdists.push_back((*distsmap)[splits->at(1)[i]]);
-		}
-	}
-}
-
 void print_vector_int(vector<int> & in){
 	for(unsigned int i=0;i<in.size();i++){
 		cout << in[i] << " ";
@@ -211,63 +196,6 @@ void print_vector_double(vector<double> & in){
 	}cout << endl;
 }
 
-inline bool IsMoreThanZero (double & i) { return (i!=0); }
-
-int get_size_for_coo(vector<vector<double> > & inmatrix, double t){
-	int count = 0;
-	int size = inmatrix.size();
-	for(int i=0;i<size;i++){
-		for(unsigned int j=0;j<inmatrix[i].size();j++){
-//			if(inmatrix[i][j]*t != 0){
-			if(inmatrix[i][j] != 0){
-				count += 1;
-			}
-		}
-		//count += (int) count_if (inmatrix[i].begin(), inmatrix[i].end(), IsMoreThanZero);
-	}return count;
-}
-
-void convert_matrix_to_coo_for_fortran(vector<vector<double> > & inmatrix, double t, int * ia, int * ja, double * a){
-	int count = 0;
-	for(unsigned int i=0;i<inmatrix.size();i++){
-		for(unsigned int j=0;j<inmatrix[i].size();j++){
-			if(inmatrix[i][j] != 0.0 ){
-				//cout << count << " " <<  i << " "<< j << " "<< inmatrix[i][j]*t << endl;
-				ia[count] = i+1;
-				ja[count] = j+1;
-				a[count] = inmatrix[i][j];
-				count += 1;
-			}
-		}
-	}
-}
-
-void convert_matrix_to_coo_for_fortran_vector(vector<vector<double> > & inmatrix, vector<int> & ia, vector<int> & ja, vector<double> & a){
-	int count = 0;
-	for(unsigned int i=0;i<inmatrix.size();i++){
-		for(unsigned int j=0;j<inmatrix[i].size();j++){
-			if(inmatrix[i][j] != 0.0 ){
-				//cout << count << " " <<  i << " "<< j << " "<< inmatrix[i][j]*t << endl;
-				ia[count] = i+1;
-				ja[count] = j+1;
-				a[count] = inmatrix[i][j];
-				count += 1;
-			}
-		}
-	}
-}
-
-
-void convert_matrix_to_single_row_for_fortran(vector<vector<double> > & inmatrix, double t, double * H){
-	int count = 0;
-	for(unsigned int i=0;i<inmatrix.size();i++){
-		for(unsigned int j=0;j<inmatrix[i].size();j++){
-			H[i+(j*inmatrix.size())] = inmatrix[i][j]*t;
-			count += 1;
-		}
-	}
-}
-
 vector<vector<vector<double> > > processRateMatrixConfigFile(string filename, int numareas, int nperiods){
 	vector<double> cols(numareas,1);
 	vector<vector<double> > rows(numareas,cols);
@@ -306,10 +234,11 @@ vector<vector<vector<double> > > processRateMatrixConfigFile(string filename, in
 /*
  * need to make this much faster
  */
-vector<int> get_columns_for_sparse(vector<double> & inc, RateModel * rm){
+template <typename Scalar>
+vector<int> get_columns_for_sparse(vector<Scalar> & inc, RateModel * rm){
 	vector<int> ret(inc.size(),0);
 	for(unsigned int i=0;i<inc.size();i++){
-		if(inc[i] > 0.0000000001){
+		if(inc[i] > Scalar(0.0000000001)){
 			ret[i] = 1;
 			vector<int> dis = rm->getDists()->at(i);
 			for(unsigned int j=0;j<inc.size();j++){
@@ -324,23 +253,9 @@ vector<int> get_columns_for_sparse(vector<double> & inc, RateModel * rm){
 	return ret;
 }
 
-vector<int> get_columns_for_sparse(vector<Superdouble> & inc, RateModel * rm){
-	vector<int> ret(inc.size(),0);
-	for(unsigned int i=0;i<inc.size();i++){
-		if(inc[i] > Superdouble(0.0000000001)){
-			ret[i] = 1;
-			vector<int> dis = rm->getDists()->at(i);
-			for(unsigned int j=0;j<inc.size();j++){
-				vector<int> dis2 = rm->getDists()->at(j);
-				int sum =calculate_vector_int_sum_xor(dis,dis2);
-				if(sum == 1){
-					ret[j] = 1;
-				}
-			}
-		}
-	}
-	return ret;
-}
+template vector<int> get_columns_for_sparse(vector<Superdouble> &,RateModel *);
+template vector<int> get_columns_for_sparse(vector<long double> &,RateModel *);
+template vector<int> get_columns_for_sparse(vector<double> &,RateModel *);
 
 /*
 	this is for parallel sparse matrix calculation
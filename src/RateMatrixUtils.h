@@ -18,10 +18,6 @@
 #include "superdouble.h"
 using namespace std;
 
-#ifdef XYZ
-#include "gmpfrxx/gmpfrxx.h"
-#endif
-
 
 /*
   most of these utilities calculate simple math on matrices and vectors
@@ -29,11 +25,10 @@ using namespace std;
   be a null vector or matrix. otherwise, c++ numerics library should
   be used for speed.
  */
-#ifdef XYZ
-double calculate_vector_mpfr_class_double_sum(vector<mpfr_class> & in);
-#endif
 double calculate_vector_double_sum(vector<double> & in);
 Superdouble calculate_vector_Superdouble_sum(vector<Superdouble> & in);
+template <typename Scalar>
+Scalar calculate_vector_scalar_sum(vector<Scalar> & in);
 int calculate_vector_int_sum(vector<int> * in);
 int get_vector_int_index_from_multi_vector_int(vector<int> * in, vector<vector<int> > * in2);
 
@@ -47,20 +42,11 @@ int locate_vector_int_single_xor(vector<int> & in, vector<int> & in2);
 /*
   given the rate model and the distribution, this should return all the 
   ancestral splits and should ONLY be used for calculating ancestral 
-  state values. otherwise the one returning only the ints should be returned
+  state values. otherwise RateModel::get_split_likelihood should be used
  */
 //vector<AncSplit> iter_ancsplits(RateModel *rm, vector<int> & dist);
 vector<AncSplit> iter_ancsplits(RateModel *rm, vector<int> & dist, int period);
 
-/*
-  like the above function but without using AncSplits object, and should be
-  used for everything but ancestral state reconstruction.
-  output is the leftdists and rightdists which are the index of the distribution
-  in the ratemodel->getdists
- */
-//void iter_ancsplits_just_int(RateModel *rm, vector<int> & dist,vector<int> & leftdists, vector<int> & rightdists, double & weight);
-void iter_ancsplits_just_int(RateModel *rm, vector<int> & dist,vector<int> & leftdists, vector<int> & rightdists, double & weight, int period);
-
 /*
   simple printing functions
  */
@@ -84,12 +70,8 @@ vector<vector<vector<double> > > processRateMatrixConfigFile(string filename, in
 
   WILL PROBABLY CHANGE WHEN MOVED TO C++ CLASSES FOR MATEXP
  */
-int get_size_for_coo(vector<vector<double> > & inm, double t);
-void convert_matrix_to_coo_for_fortran(vector<vector<double> > & inmatrix, double t, int * ia, int * ja, double * a);
-void convert_matrix_to_coo_for_fortran_vector(vector<vector<double> > & inmatrix, vector<int> & ia, vector<int> & ja, vector<double> & a);
-void convert_matrix_to_single_row_for_fortran(vector<vector<double> > & inmatrix, double t, double * H);
-vector<int> get_columns_for_sparse(vector<double> &,RateModel *);
-vector<int> get_columns_for_sparse(vector<Superdouble> &,RateModel *);
+template <typename Scalar>
+vector<int> get_columns_for_sparse(vector<Scalar> &,RateModel *);
 
 /*
 	this is for pthread sparse columns
@@ -35,7 +35,8 @@ using namespace std;
 
 RateModel::RateModel(int na, bool ge, vector<double> pers, bool sp, bool cv, bool ra):
 	globalext(ge),nareas(na),numthreads(0),periods(pers),sparse(sp),
-	classic_vicariance(cv), rapid_anagenesis(ra), default_adjacency(true),maxareas(1){}
+	classic_vicariance(cv), rapid_anagenesis(ra), default_adjacency(true),maxareas(1),
+	P_action(&banded_q::Matrix::exp_action<0>){}
 
 void RateModel::set_nthreads(int nthreads){
 	numthreads = nthreads;
@@ -68,6 +69,8 @@ void RateModel::setup_dists(){
 	for(unsigned int i=0;i<dists.size();i++){
 		intdistsmap[i] = dists[i];
 	}
+	index_dists();
+	P_action = banded_q::action_for(dists.size());
 	/*
 	 * precalculate the iterdists
 	 */
@@ -134,6 +137,8 @@ void RateModel::setup_dists(vector<vector<int> > indists, bool include,
 	for(unsigned int i=0;i<dists.size();i++){
 		intdistsmap[i] = dists[i];
 	}
+	index_dists();
+	P_action = banded_q::action_for(dists.size());
 	/*
 	precalculate the iterdists
 	 */
@@ -202,9 +207,7 @@ void RateModel::remove_dist(vector<int> dist);*/
  * specify particular ones in the Dmask_cell
  */
 void RateModel::setup_Dmask(){
-	vector<double> cols(nareas, 1);
-	vector< vector<double> > rows(nareas, cols);
-	Dmask = vector< vector< vector<double> > > (periods.size(), rows);
+	Dmask.assign(periods.size(), matrix::Matrix(nareas, nareas, 1));
 }
 
 void RateModel::set_Dmask_cell(int period, int area, int area2, double prob, bool sym){
@@ -214,13 +217,11 @@ void RateModel::set_Dmask_cell(int period, int area, int area2, double prob, boo
 }
 
 void RateModel::setup_D(double d){
-	vector<double> cols(nareas, 1*d);
-	vector< vector<double> > rows(nareas, cols);
-	D = vector< vector< vector<double> > > (periods.size(), rows);
+	D.assign(periods.size(), matrix::Matrix(nareas, nareas, 1*d));
 	for (unsigned int i=0;i<D.size();i++){
-		for (unsigned int j=0;j<D[i].size();j++){
+		for (int j=0;j<D[i].rows();j++){
 			D[i][j][j] = 0.0;
-			for (unsigned int k=0;k<D[i][j].size();k++){
+			for (int k=0;k<D[i].cols();k++){
 				D[i][j][k] = D[i][j][k] * Dmask[i][j][k];
 			}
 		}
@@ -228,8 +229,8 @@ void RateModel::setup_D(double d){
 	if (VERBOSE){
 		cout << "D" <<endl;
 		for (unsigned int i=0;i<D.size();i++){
-			for (unsigned int j=0;j<D[i].size();j++){
-				for (unsigned int k=0;k<D[i][j].size();k++){
+			for (int j=0;j<D[i].rows();j++){
+				for (int k=0;k<D[i].cols();k++){
 					cout << D[i][j][k] << " ";
 				}
 				cout << endl;
@@ -246,13 +247,11 @@ void RateModel::setup_D(double d){
  */
 
 void RateModel::setup_D_provided(double d, vector< vector< vector<double> > > & D_mask_in){
-	vector<double> cols(nareas, 1*d);
-	vector< vector<double> > rows(nareas, cols);
-	D = vector< vector< vector<double> > > (periods.size(), rows);
+	D.assign(periods.size(), matrix::Matrix(nareas, nareas, 1*d));
 	for (unsigned int i=0;i<D.size();i++){
-		for (unsigned int j=0;j<D[i].size();j++){
+		for (int j=0;j<D[i].rows();j++){
 			D[i][j][j] = 0.0;
-			for (unsigned int k=0;k<D[i][j].size();k++){
+			for (int k=0;k<D[i].cols();k++){
 				D[i][j][k] = D[i][j][k] * Dmask[i][j][k]*D_mask_in[i][j][k];
 			}
 		}
@@ -260,8 +259,8 @@ void RateModel::setup_D_provided(double d, vector< vector< vector<double> > > &
 	if (VERBOSE){
 		cout << "D" <<endl;
 		for (unsigned int i=0;i<D.size();i++){
-			for (unsigned int j=0;j<D[i].size();j++){
-				for (unsigned int k=0;k<D[i][j].size();k++){
+			for (int j=0;j<D[i].rows();j++){
+				for (int k=0;k<D[i].cols();k++){
 					cout << D[i][j][k] << " ";
 				}
 				cout << endl;
@@ -272,22 +271,47 @@ void RateModel::setup_D_provided(double d, vector< vector< vector<double> > > &
 }
 
 void RateModel::setup_E(double e){
-	vector<double> cols(nareas, 1*e);
-	E = vector<vector<double> > (periods.size(), cols);
+	E = matrix::Matrix(periods.size(), nareas, 1*e);
+}
+
+/*
+ * rates of a single period, once D and E are set up:
+ * the Q of the other periods keep their version
+ */
+void RateModel::set_D_period(int period, double d){
+	matrix::Matrix & dp = D[period];
+	for (int j=0;j<dp.rows();j++){
+		for (int k=0;k<dp.cols();k++){
+			dp[j][k] = (j == k) ? 0.0 : d * Dmask[period][j][k];
+		}
+	}
+}
+
+void RateModel::set_E_period(int period, double e){
+	for (int j=0;j<E.cols();j++){
+		E[period][j] = e;
+	}
 }
 
 void RateModel::set_Qdiag(int period){
-	for (unsigned int i=0;i<dists.size();i++){
-		double sum =(calculate_vector_double_sum(Q[period][i]) - Q[period][i][i]) * -1.0;
-		Q[period][i][i] = sum;
+	matrix::Matrix & q = Q[period];
+	for (int i=0;i<q.rows();i++){
+		double rowsum = 0.0;
+		for (int j=0;j<q.cols();j++){
+			rowsum += q[i][j];
+		}
+		q[i][i] = (rowsum - q[i][i]) * -1.0;
 	}
 }
 
 void RateModel::setup_Q(){
-	vector<double> cols(dists.size(), 0);
-	vector< vector<double> > rows(dists.size(), cols);
-	Q = vector< vector< vector<double> > > (periods.size(), rows);
+	Q.resize(periods.size());
+	P.resize(periods.size());
+	Q_banded.resize(periods.size());
+	Q_versions.resize(periods.size(), 0);
 	for(unsigned int p=0; p < Q.size(); p++){//periods
+		matrix::Matrix previous = std::move(Q[p]);
+		Q[p] = matrix::Matrix(dists.size(), dists.size());
 		for(unsigned int i=0;i<dists.size();i++){//dists
 			//int s1 = calculate_vector_int_sum(&dists[i]);
 			int s1 = accumulate(dists[i].begin(),dists[i].end(),0);
@@ -314,45 +338,13 @@ void RateModel::setup_Q(){
 			}
 		}
 		set_Qdiag(p);
-	}
-	/*
-	 * sparse needs to be transposed for matrix exponential calculation
-	 */
-	if(sparse == true){
-		vector<double> cols(dists.size(), 0);
-		vector< vector<double> > rows(dists.size(), cols);
-		QT = vector< vector< vector<double> > > (periods.size(), rows);
-		for(unsigned int p=0; p < QT.size(); p++){//periods
-			for(unsigned int i=0;i<dists.size();i++){//dists
-				for(unsigned int j=0;j<dists.size();j++){//dists
-					QT[p][j][i] = Q[p][i][j];
-				}
-			}
-		}
-		//setting up the coo numbs
-		nzs = vector<int>(Q.size(),0);
-		for(unsigned int p=0; p < Q.size(); p++){//periods
-			nzs[p] = get_size_for_coo(Q[p],1);
-		}
-		//setup matrix
-		ia_s.clear();
-		ja_s.clear();
-		a_s.clear();
-		for(unsigned int p=0; p < Q.size(); p++){//periods
-			vector<int> ia = vector<int>(nzs[p]);
-			vector<int> ja = vector<int>(nzs[p]);
-			vector<double> a = vector<double>(nzs[p]);
-			convert_matrix_to_coo_for_fortran_vector(QT[p],ia,ja,a);//need to multiply these all these by t
-			ia_s.push_back(ia);
-			ja_s.push_back(ja);
-			a_s.push_back(a);
-		}
+		commit_Q(p, previous, dists);
 	}
 	if(VERBOSE){
 	cout << "Q" <<endl;
 		for (unsigned int i=0;i<Q.size();i++){
-			for (unsigned int j=0;j<Q[i].size();j++){
-				for (unsigned int k=0;k<Q[i][j].size();k++){
+			for (int j=0;j<Q[i].rows();j++){
+				for (int k=0;k<Q[i].cols();k++){
 					cout << Q[i][j][k] << " ";
 				}
 				cout << endl;
@@ -363,99 +355,174 @@ void RateModel::setup_Q(){
 }
 
 void RateModel::set_Qdiag_with_adjacency(int period){
-	for (unsigned int i=0;i<incldists_per_period[period].size();i++){
-		double sum =(calculate_vector_double_sum(Q[period][i]) - Q[period][i][i]) * -1.0;
-		Q[period][i][i] = sum;
+	matrix::Matrix & q = Q[period];
+	for (int i=0;i<q.rows();i++){
+		double rowsum = 0.0;
+		for (int j=0;j<q.cols();j++){
+			rowsum += q[i][j];
+		}
+		q[i][i] = (rowsum - q[i][i]) * -1.0;
 	}
 }
 
-void RateModel::setup_Q_with_adjacency(){
+/*
+ * the rest of Q only follows when it differs from the previous one:
+ * a period whose rates are left unchanged keeps its version
+ */
+void RateModel::commit_Q(int period, const matrix::Matrix & previous, vector<vector<int> > & ranges){
+	if (Q[period] == previous)
+		return;
+	setup_Q_banded(period, ranges);
+	Q_versions[period]++;
+}
+
+unsigned long RateModel::get_Q_version(int period){
+	return Q_versions[period];
+}
+
+void RateModel::setup_Q_banded(int period, vector<vector<int> > & ranges){
+	vector<int> sizes(ranges.size());
+	for(unsigned int i=0;i<ranges.size();i++){
+		sizes[i] = accumulate(ranges[i].begin(),ranges[i].end(),0);
+	}
+	Q_banded[period] = banded_q::Matrix(Q[period], sizes);
+}
+
+/*
+ * collect which D and E terms sum up into each cell of Q, only once:
+ * this does not depend on their values
+ */
+void RateModel::setup_Q_pattern(){
+	Q_cells.resize(periods.size());
+	Q_terms.resize(periods.size());
+	Q_pattern_extent.resize(periods.size(), 0);
 	for(unsigned int p=0; p < periods.size(); p++){//periods
-		vector<double> cols(incldists_per_period[p].size(), 0);
-		vector< vector<double> > rows(incldists_per_period[p].size(), cols);
-		Q.push_back(rows);
-		for(unsigned int i=0;i<incldists_per_period[p].size();i++){//incldists_per_period[p]
-			int s1 = accumulate(incldists_per_period[p][i].begin(),incldists_per_period[p][i].end(),0);
-			if ((s1 > 0) && s1 <= maxareas){
-				for(unsigned int j=0;j<incldists_per_period[p].size();j++){//incldists_per_period[p]
-					int sxor = calculate_vector_int_sum_xor(incldists_per_period[p][i], incldists_per_period[p][j]);
-					int s2 = accumulate(incldists_per_period[p][j].begin(),incldists_per_period[p][j].end(),0);
-					double rate = 0.0;
+		if (Q_pattern_extent[p] < incldists_per_period[p].size())
+			setup_Q_pattern(p, Q_pattern_extent[p]);
+	}
+}
 
-					if (sxor == 1){
-						int dest = locate_vector_int_single_xor(incldists_per_period[p][i],incldists_per_period[p][j]);
-						if (s1 < s2){
-							for (unsigned int src=0;src<incldists_per_period[p][i].size();src++){
-								if(incldists_per_period[p][i][src] != 0){
-									rate += D[p][src][dest] ;//* Dmask[p][src][dest];
-								}
+/*
+ * extend the pattern to the incldists_per_period[p] added from index "from"
+ * (ie. the tip ranges included after the pattern was read from cache)
+ */
+void RateModel::setup_Q_pattern(int p, size_t from){
+	vector<vector<int> > & incl = incldists_per_period[p];
+	vector<Qcell> & cells = Q_cells[p];
+	vector<Qterm> & terms = Q_terms[p];
+	for(unsigned int i=0;i<incl.size();i++){//incldists_per_period[p]
+		int s1 = accumulate(incl[i].begin(),incl[i].end(),0);
+		if ((s1 > 0) && s1 <= maxareas){
+			for(unsigned int j=(i < from ? from : 0);j<incl.size();j++){//incldists_per_period[p]
+				int sxor = calculate_vector_int_sum_xor(incl[i], incl[j]);
+				int s2 = accumulate(incl[j].begin(),incl[j].end(),0);
+				Qcell cell = {int(i), int(j), int(terms.size()), 0};
+
+				if (sxor == 1){
+					int dest = locate_vector_int_single_xor(incl[i],incl[j]);
+					if (s1 < s2){
+						for (unsigned int src=0;src<incl[i].size();src++){
+							if(incl[i][src] != 0){
+								terms.push_back(Qterm{int(src), dest});
 							}
-						}else{
-							rate = E[p][dest];
 						}
+					}else{
+						terms.push_back(Qterm{-1, dest});
 					}
+				}
 
-					//	for rapid range expansion/contraction during anagenesis
-					else if (rapid_anagenesis && (sxor == 2)) {
-						vector<int> xor_dist = calculate_vector_int_xor_vector(incldists_per_period[p][i],incldists_per_period[p][j]);
-						for (size_t xor_idx = 0; xor_idx < xor_dist.size(); xor_idx++) {
-							if ((xor_dist[xor_idx] == 1) && (incldists_per_period[p][j][xor_idx] == 1)) {
-								for (size_t src = 0; src < s1; src++)
-									if(incldists_per_period[p][i][src] != 0)
-										rate += D[p][src][xor_idx];
-							}
-							else if ((xor_dist[xor_idx] == 1) && (incldists_per_period[p][i][xor_idx] == 1))
-								rate += E[p][xor_idx];
+				//	for rapid range expansion/contraction during anagenesis
+				else if (rapid_anagenesis && (sxor == 2)) {
+					vector<int> xor_dist = calculate_vector_int_xor_vector(incl[i],incl[j]);
+					for (size_t xor_idx = 0; xor_idx < xor_dist.size(); xor_idx++) {
+						if ((xor_dist[xor_idx] == 1) && (incl[j][xor_idx] == 1)) {
+							for (size_t src = 0; src < s1; src++)
+								if(incl[i][src] != 0)
+									terms.push_back(Qterm{int(src), int(xor_idx)});
 						}
+						else if ((xor_dist[xor_idx] == 1) && (incl[i][xor_idx] == 1))
+							terms.push_back(Qterm{-1, int(xor_idx)});
 					}
-
-					Q[p][i][j] = rate;
 				}
+
+				cell.last = terms.size();
+				if (cell.last > cell.first)
+					cells.push_back(cell);
+			}
+		}
+	}
+	//	special case of "big tip" distributions which are added only during the most recent time period
+	//	(last, since they overwrite some of the cells above)
+	for(unsigned int i=from;i<incl.size();i++){
+		int s1 = accumulate(incl[i].begin(),incl[i].end(),0);
+		if ((p == 0) && (s1 > maxareas)) {
+			int tip_anc_size = 1;
+			//	looping through all the "left" dist splits of this big tip distribution
+			for (size_t k = 0; k < iter_dists_per_period[incl[i]][p][0].size();k++) {
+				int split_dist_size = calculate_vector_int_sum(&iter_dists_per_period[incl[i]][p][0][k]);
+				//	searching for the smallest possible contraction of the range size of this big tip
+				if ((split_dist_size > tip_anc_size) && (split_dist_size < s1))
+					tip_anc_size = split_dist_size;
 			}
-			//	special case of "big tip" distributions which are added only during the most recent time period
-			else if ((p == 0) && (s1 > maxareas)) {
-				int tip_anc_size = 1;
-				//	looping through all the "left" dist splits of this big tip distribution
-				for (size_t k = 0; k < iter_dists_per_period[incldists_per_period[p][i]][p][0].size();k++) {
-					int split_dist_size = calculate_vector_int_sum(&iter_dists_per_period[incldists_per_period[p][i]][p][0][k]);
-					//	searching for the smallest possible contraction of the range size of this big tip
-					if ((split_dist_size > tip_anc_size) && (split_dist_size < s1))
-						tip_anc_size = split_dist_size;
-				}
 
-				// 	search for tip_anc_size'd contiguous sub-ranges/splits for the big tip
-				map<int,int> combidx2distidxmap;
-				int counter = 0;
-				for (unsigned int area = 0; area < nareas; area++) {
-					if (incldists_per_period[p][i][area] == 1) {
-						combidx2distidxmap[counter] = area;
-						++counter;
-					}
+			// 	search for tip_anc_size'd contiguous sub-ranges/splits for the big tip
+			map<int,int> combidx2distidxmap;
+			int counter = 0;
+			for (unsigned int area = 0; area < nareas; area++) {
+				if (incl[i][area] == 1) {
+					combidx2distidxmap[counter] = area;
+					++counter;
 				}
+			}
 
-				// 	generate tip_anc_size'd splits
-				vector<vector<int> > range_comb_idxs = iterate(s1, tip_anc_size);
-
-				for (unsigned int k = 0; k < range_comb_idxs.size(); k++) {
-					vector<int> split_dist = comb_idx2bit_vect(range_comb_idxs[k], nareas, combidx2distidxmap);
-					//	keep only contiguous splits
-					if (count(incldists_per_period[p].begin(),incldists_per_period[p].end(), split_dist) > 0) {
-						int split_dist_index = distance(incldists_per_period[p].begin(),find(incldists_per_period[p].begin(),incldists_per_period[p].end(),split_dist));
-						vector<int> xor_dist = calculate_vector_int_xor_vector(incldists_per_period[p][i],split_dist);
-						//	consider dispersal from these splits towards the big tip
-						double rate = 0.0;
-						for (size_t dest = 0; dest < xor_dist.size(); dest++)
-							if (xor_dist[dest] == 1)
-								for (size_t src = 0; src < split_dist.size(); src++)
-									if(split_dist[src] != 0)
-										rate += D[p][src][dest];
-
-						Q[p][split_dist_index][i] = rate;
-					}
+			// 	generate tip_anc_size'd splits
+			vector<vector<int> > range_comb_idxs = iterate(s1, tip_anc_size);
+
+			for (unsigned int k = 0; k < range_comb_idxs.size(); k++) {
+				vector<int> split_dist = comb_idx2bit_vect(range_comb_idxs[k], nareas, combidx2distidxmap);
+				//	keep only contiguous splits
+				if (count(incl.begin(),incl.end(), split_dist) > 0) {
+					int split_dist_index = distance(incl.begin(),find(incl.begin(),incl.end(),split_dist));
+					vector<int> xor_dist = calculate_vector_int_xor_vector(incl[i],split_dist);
+					//	consider dispersal from these splits towards the big tip
+					Qcell cell = {split_dist_index, int(i), int(terms.size()), 0};
+					for (size_t dest = 0; dest < xor_dist.size(); dest++)
+						if (xor_dist[dest] == 1)
+							for (size_t src = 0; src < split_dist.size(); src++)
+								if(split_dist[src] != 0)
+									terms.push_back(Qterm{int(src), int(dest)});
+					cell.last = terms.size();
+					cells.push_back(cell);
 				}
 			}
 		}
+	}
+	Q_pattern_extent[p] = incl.size();
+}
+
+void RateModel::setup_Q_with_adjacency(){
+	setup_Q_pattern();
+	Q.resize(periods.size());
+	P.resize(periods.size());
+	Q_banded.resize(periods.size());
+	Q_versions.resize(periods.size(), 0);
+	for(unsigned int p=0; p < periods.size(); p++){//periods
+		matrix::Matrix previous = std::move(Q[p]);
+		Q[p] = matrix::Matrix(incldists_per_period[p].size(), incldists_per_period[p].size());
+		for (unsigned int c=0;c<Q_cells[p].size();c++){
+			const Qcell & cell = Q_cells[p][c];
+			double rate = 0.0;
+			for (int t=cell.first;t<cell.last;t++){
+				const Qterm & term = Q_terms[p][t];
+				if (term.src < 0)
+					rate += E[p][term.dest];
+				else
+					rate += D[p][term.src][term.dest];
+			}
+			Q[p][cell.row][cell.col] = rate;
+		}
 		set_Qdiag_with_adjacency(p);
+		commit_Q(p, previous, incldists_per_period[p]);
 	}
 	/*
 	 * sparse matrices will be handled later
@@ -468,8 +535,8 @@ void RateModel::setup_Q_with_adjacency(){
 	if(VERBOSE){
 		cout << "Q" <<endl;
 		for (unsigned int i=0;i<Q.size();i++){
-			for (unsigned int j=0;j<Q[i].size();j++){
-				for (unsigned int k=0;k<Q[i][j].size();k++){
+			for (int j=0;j<Q[i].rows();j++){
+				for (int k=0;k<Q[i].cols();k++){
 					cout << Q[i][j][k] << " ";
 				}
 				cout << endl;
@@ -481,57 +548,17 @@ void RateModel::setup_Q_with_adjacency(){
 
 
 
-extern"C" {
-	void wrapalldmexpv_(int * n,int* m,double * t,double* v,double * w,double* tol,
-		double* anorm,double* wsp,int * lwsp,int* iwsp,int *liwsp, int * itrace,int *iflag,
-		int *ia, int *ja, double *a, int *nz, double * res);
-	void wrapsingledmexpv_(int * n,int* m,double * t,double* v,double * w,double* tol,
-			double* anorm,double* wsp,int * lwsp,int* iwsp,int *liwsp, int * itrace,int *iflag,
-			int *ia, int *ja, double *a, int *nz, double * res);
-	void wrapdgpadm_(int * ideg,int * m,double * t,double * H,int * ldh,
-			double * wsp,int * lwsp,int * ipiv,int * iexph,int *ns,int *iflag );
-}
-
 /*
- * runs the basic padm fortran expokit full matrix exp
+ * runs the scaling and squaring pade matrix exp (see pade.hpp)
  */
-vector<vector<double > > RateModel::setup_fortran_P(int period, double t, bool store_p_matrices){
+matrix::View RateModel::setup_pade_P(int period, double t, bool store_p_matrices){
 	/*
 	return P, the matrix of dist-to-dist transition probabilities,
-	from the model's rate matrix (Q) over a time duration (t)
+	from the model's rate matrix (Q) over a time duration (t),
+	either stored for the reverse pass or in P[period] until the next call
 	*/
-	int ideg = 6;
-	int m = Q[period].size();
-	int ldh = m;
-	double tol = 1;
-	int iflag = 0;
-	int lwsp = 4*m*m+6+1;
-	double * wsp = new double[lwsp];
-	int * ipiv = new int[m];
-	int iexph = 0;
-	int ns = 0;
-	double * H = new double [m*m];
-	convert_matrix_to_single_row_for_fortran(Q[period],t,H);
-	wrapdgpadm_(&ideg,&m,&tol,H,&ldh,wsp,&lwsp,ipiv,&iexph,&ns,&iflag);
-	vector<vector<double> > p (Q[period].size(), vector<double>(Q[period].size()));
-	for(int i=0;i<m;i++){
-		for(int j=0;j<m;j++){
-			p[i][j] = wsp[iexph+(j-1)*m+(i-1)+m];
-		}
-	}
-	delete [] wsp;
-	delete [] ipiv;
-	delete [] H;
-	for(unsigned int i=0; i<p.size(); i++){
-		double sum = 0.0;
-		for (unsigned int j=0; j<p[i].size(); j++){
-			sum += p[i][j];
-		}
-		for (unsigned int j=0; j<p[i].size(); j++){
-			p[i][j] = (p[i][j]/sum);
-		}
-	}
-
+	matrix::Matrix & p = store_p_matrices ? stored_p_matrices[period][t] : P[period];
+	pade_P(Q[period], t, pade_workspace, p);
 
 	//filter out impossible dists
 	//vector<vector<int> > dis = enumerate_dists();
@@ -557,17 +584,10 @@ vector<vector<double > > RateModel::setup_fortran_P(int period, double t, bool s
 		}
 	}*/
 
-	/*
-	 if store_p_matrices we will store them
-	 */
-	if(store_p_matrices == true){
-		stored_p_matrices[period][t] = p;
-	}
-
 	if(VERBOSE){
 	cout << "p " << period << " "<< t << endl;
-		for (unsigned int i=0;i<p.size();i++){
-			for (unsigned int j=0;j<p[i].size();j++){
+		for (int i=0;i<p.rows();i++){
+			for (int j=0;j<p.cols();j++){
 				cout << p[i][j] << " ";
 			}
 			cout << endl;
@@ -577,140 +597,36 @@ vector<vector<double > > RateModel::setup_fortran_P(int period, double t, bool s
 }
 
 /*
- * runs the sparse matrix fortran expokit matrix exp
+ * the same from any Q, within the caller's workspace (one per thread)
  */
-vector<vector<double > > RateModel::setup_sparse_full_P(int period, double t){
-	int n = Q[period].size();
-	int m = Q[period].size()-1;//tweak
-	int nz = get_size_for_coo(Q[period],1);
-	int * ia = new int [nz];
-	int * ja = new int [nz];
-	double * a = new double [nz];
-	convert_matrix_to_coo_for_fortran(Q[period],t,ia,ja,a);
-	double * v = new double [n];
-	for(int i=0;i<n;i++){
-		v[i] = 0;
-	}v[0]= 1;
-	double * w = new double [n];
-	int ideg = 6;
-	double tol = 1;
-	int iflag = 0;
-	int lwsp = n*(m+1)+n+pow((m+2.),2)+4*pow((m+2.),2)+ideg+1;
-	double * wsp = new double[lwsp];
-	int liwsp = m+2;
-	int * iwsp = new int [liwsp];
-	double t1 = 1;
-	double anorm = 0;
-	int itrace = 0;
-	double * res = new double [n*n];
-	wrapalldmexpv_(&n,&m,&t1,v,w,&tol,&anorm,wsp,&lwsp,iwsp,&liwsp,
-			&itrace,&iflag,ia,ja,a,&nz,res);
-
-	vector<vector<double> > p (Q[period].size(), vector<double>(Q[period].size()));
-	int count = 0;
-	for(int i=0;i<n;i++){
-		for(int j=0;j<n;j++){
-			p[j][i] = res[count];
-			count += 1;
+void RateModel::pade_P(const matrix::Matrix & q, double t, pade::Workspace & ws, matrix::Matrix & p){
+	int m = q.rows();
+	double * H = ws.argument(m);
+	for(int i=0;i<m;i++){
+		for(int j=0;j<m;j++){
+			H[i+j*m] = q[i][j]*t;
 		}
 	}
-
-	//filter out impossible dists
-	//vector<vector<int> > dis = enumerate_dists();
-	for (unsigned int i=0;i<dists.size();i++){
-		//if (calculate_vector_int_sum(&dists[i]) > 0){
-		if(accumulate(dists[i].begin(),dists[i].end(),0) > 0){
-			for(unsigned int j=0;j<dists[i].size();j++){
-				if(dists[i][j]==1){//present
-					double sum1 =calculate_vector_double_sum(Dmask[period][j]);
-					double sum2 = 0.0;
-					for(unsigned int k=0;k<Dmask[period].size();k++){
-						sum2 += Dmask[period][k][j];
-					}
-					if(sum1+sum2 == 0){
-						for(unsigned int k=0;k<p[period].size();k++){
-							p[period][k] = p[period][k]*0.0;
-						}
-						break;
-					}
-				}
-			}
+	const double * expH = pade::exp(ws);
+	if (p.rows() != m)
+		p = matrix::Matrix(m, m);
+	for(int i=0;i<m;i++){
+		double sum = 0.0;
+		for(int j=0;j<m;j++){
+			sum += expH[i+j*m];
 		}
-	}
-	delete []res;
-	delete []iwsp;
-	delete []w;
-	delete []wsp;
-	delete []a;
-	delete []ia;
-	delete []ja;
-	if(VERBOSE){
-		cout << "p " << period << " "<< t << endl;
-		for (unsigned int i=0;i<p.size();i++){
-			for (unsigned int j=0;j<p[i].size();j++){
-				cout << p[i][j] << " ";
-			}
-			cout << endl;
+		for(int j=0;j<m;j++){
+			p[i][j] = (expH[i+j*m]/sum);
 		}
 	}
-	return p;
 }
 
 /*
- * for returning single P columns
+ * overwrites v (indexed like Q[period]) with P.v, without forming P:
+ * cheaper than setup_pade_P when P is not needed afterwards
  */
-vector<double >  RateModel::setup_sparse_single_column_P(int period, double t, int column){
-	int n = Q[period].size();
-	int m = nareas-1;
-	int nz = nzs[period];//get_size_for_coo(Q[period],1);
-	int * ia = new int [nz];
-	int * ja = new int [nz];
-	double * a = new double [nz];
-	//convert_matrix_to_coo_for_fortran(QT[period],1,ia,ja,a);
-	std::copy(ia_s[period].begin(), ia_s[period].end(), ia);
-	std::copy(ja_s[period].begin(), ja_s[period].end(), ja);
-	std::copy(a_s[period].begin(), a_s[period].end(), a);
-	double * v = new double [n];
-	for(int i=0;i<n;i++){
-		v[i] = 0;
-	}v[column]= 1; // only return the one column we want
-	double * w = new double [n];
-	int ideg = 6;
-	double tol = 1;
-	int iflag = 0;
-	int lwsp = n*(m+1)+n+pow((m+2.),2)+4*pow((m+2.),2)+ideg+1;
-	double * wsp = new double[lwsp];
-	int liwsp = m+2;
-	int * iwsp = new int [liwsp];
-	double t1 = t;//use to be 1
-	double anorm = 0;
-	int itrace = 0;
-	double * res = new double [n]; // only needs resulting columns
-	wrapsingledmexpv_(&n,&m,&t1,v,w,&tol,&anorm,wsp,&lwsp,iwsp,&liwsp,
-			&itrace,&iflag,ia,ja,a,&nz,res);
-
-	vector<double> p (Q[period].size());
-	int count = 0;
-	for(int i=0;i<n;i++){
-		p[i] = res[count];
-		count += 1;
-	}
-	delete []v;
-	delete []res;
-	delete []iwsp;
-	delete []w;
-	delete []wsp;
-	delete []a;
-	delete []ia;
-	delete []ja;
-	if(VERBOSE){
-		cout << "p " << period << " "<< t << " " << column <<  endl;
-		for (unsigned int i=0;i<p.size();i++){
-			cout << p[i] << " ";
-		}
-		cout << endl;
-	}
-	return p;
+void RateModel::setup_P_action(int period, double t, vector<double> & v){
+	(Q_banded[period].*P_action)(t, v);
 }
 
 /*
@@ -848,7 +764,7 @@ map<int,vector<vector<vector<int> > > > RateModel::iter_dist_splits_per_period(v
 		vector<vector<int> > right;
 		//	if this dist is connected during the specified time period
 //		if ((distSize <= maxareas) && (count(incldists_per_period[per].begin(),incldists_per_period[per].end(), dist) > 0)) {
-		if (count(incldists_per_period[per].begin(),incldists_per_period[per].end(), dist) > 0) {
+		if (is_incldist(dist, per)) {
 			if (distSize == 1) {
 				left.push_back(dist);
 				right.push_back(dist);
@@ -857,8 +773,7 @@ map<int,vector<vector<vector<int> > > > RateModel::iter_dist_splits_per_period(v
 					if (dist[i] == 1) {
 						vector<int> x(dist.size(), 0);
 						x[i] = 1;
-						int cou = count(incldists_per_period[per].begin(),incldists_per_period[per].end(), x);
-						if (cou > 0) {
+						if (is_incldist(x, per)) {
 							left.push_back(x);
 							right.push_back(dist);
 							left.push_back(dist);
@@ -871,8 +786,7 @@ map<int,vector<vector<vector<int> > > > RateModel::iter_dist_splits_per_period(v
 									y.push_back(1);
 								}
 							}
-							int cou2 = count(incldists_per_period[per].begin(),incldists_per_period[per].end(), y);
-							if (cou2 > 0) {
+							if (is_incldist(y, per)) {
 								left.push_back(x);
 								right.push_back(y);
 								if (accumulate(y.begin(), y.end(), 0) > 1) {
@@ -904,8 +818,7 @@ map<int,vector<vector<vector<int> > > > RateModel::iter_dist_splits_per_period(v
 						for (unsigned int j = 0; j < range_comb_idxs.size(); j++) {
 							vector<int> split1 = comb_idx2bit_vect(range_comb_idxs[j], nareas, combidx2distidxmap);
 							vector<int> split2 = calculate_vector_int_xor_vector(dist, split1);
-							if ((count(incldists_per_period[per].begin(),incldists_per_period[per].end(), split1) > 0)
-									&& (count(incldists_per_period[per].begin(),incldists_per_period[per].end(), split2) > 0)
+							if (is_incldist(split1, per) && is_incldist(split2, per)
 									&& (find(left.begin(),left.end(),split1) == left.end())) {
 									left.push_back(split1); right.push_back(split2);
 									left.push_back(split2); right.push_back(split1);
@@ -924,9 +837,48 @@ map<int,vector<vector<vector<int> > > > RateModel::iter_dist_splits_per_period(v
 
 void RateModel::iter_all_dist_splits_per_period() {
 	for (unsigned int i = 0; i < dists.size(); i++) {
+		//	splits read from cache are kept unless tip ranges have changed them
+		if ((iter_dists_per_period.count(dists[i]) > 0) && (stale_splits.count(dists[i]) == 0))
+			continue;
 		int distSize = accumulate(dists[i].begin(),dists[i].end(),0);
 		iter_dists_per_period[dists[i]] = iter_dist_splits_per_period(dists[i],distSize);
 	}
+	stale_splits.clear();
+	iter_dists_per_period_int.resize(dists.size());
+	for (unsigned int i = 0; i < dists.size(); i++)
+		iter_dists_per_period_int[i] = &iter_dists_per_period[dists[i]];
+
+	splits_per_period.assign(periods.size(), cladogenesis::Splits(dists.size()));
+	for (unsigned int per = 0; per < periods.size(); per++) {
+		for (unsigned int i = 0; i < dists.size(); i++) {
+			vector<vector<vector<int> > > & splits = (*iter_dists_per_period_int[i])[per];
+			for (unsigned int j = 0; j < splits[0].size(); j++) {
+				int left = distsindex(splits[0][j]);
+				int right = distsindex(splits[1][j]);
+				splits_per_period[per].add(i, left, accumulate(splits[0][j].begin(),splits[0][j].end(),0) == 1,
+						right, accumulate(splits[1][j].begin(),splits[1][j].end(),0) == 1);
+			}
+		}
+	}
+}
+
+/*
+ * (re)build the lookup of dist ints from dists,
+ * and of the positions of these within each period
+ */
+void RateModel::index_dists()
+{
+	distsindex = range_index::Index(dists);
+	incldistspos_per_period.assign(incldistsint_per_period.size(), vector<int>(dists.size(), -1));
+	for (unsigned int prd = 0; prd < incldistsint_per_period.size(); prd++)
+		for (unsigned int i = 0; i < incldistsint_per_period[prd].size(); i++)
+			incldistspos_per_period[prd][incldistsint_per_period[prd][i]] = i;
+}
+
+bool RateModel::is_incldist(vector<int> & dist, int period)
+{
+	int distint = distsindex(dist);
+	return (distint >= 0) && (incldistspos_per_period[period][distint] >= 0);
 }
 
 
@@ -1010,6 +962,28 @@ vector< vector<int> > RateModel::generate_adjacent_dists(int maxareas, map<int,s
 	return rangemap;
 }
 
+/*
+ * same as above, but also precompute the splits and Q pattern of these ranges,
+ * or read them all from the cache file if it was written for the same geography
+ */
+vector< vector<int> > RateModel::generate_cached_adjacent_dists(int maxareas, map<int,string> areanamemaprev, const string & cachefile)
+{
+	RateModel::maxareas = maxareas;
+	RateModel::areanamemaprev = areanamemaprev;
+	vector< vector<int> > rangemap;
+	if (model_cache::load(cachefile, *this, rangemap))
+		return rangemap;
+
+	rangemap = generate_adjacent_dists(maxareas, areanamemaprev);
+	//	before any tip range is included
+	dists = rangemap;
+	index_dists();
+	iter_all_dist_splits_per_period();
+	setup_Q_pattern();
+	model_cache::save(cachefile, *this, rangemap);
+	return rangemap;
+}
+
 
 vector< vector<int> >  RateModel::iterate_all_from_num_max_areas(int m, int n){
 	vector< vector<int> > results;
@@ -1043,6 +1017,16 @@ void RateModel::include_tip_dists(map<string,vector<int> > distrib_data, vector<
 					incldists_per_period[0].push_back(*it);
 					incldistsint_per_period[0].push_back(distance(includedists.begin(),find(includedists.begin(),includedists.end(),distrib_data[taxon])));
 					excldists_per_period[0].erase(it);
+					//	this range now splits into/from its sub-ranges
+					for (unsigned int i = 0; i < incldists_per_period[0].size(); i++) {
+						vector<int> & super = incldists_per_period[0][i];
+						bool contains = true;
+						for (int area = 0; area < nareas; area++)
+							if (distrib_data[taxon][area] > super[area])
+								contains = false;
+						if (contains)
+							stale_splits.insert(super);
+					}
 					cout << "For an example of the missing taxon distribution cf. " << taxon
 						 << " (" << print_area_vector(distrib_data[taxon],areanamemaprev) << ")" << endl;
 				}
@@ -1086,6 +1070,20 @@ map<int,vector<int> > * RateModel::get_int_dists_map(){
 	return &intdistsmap;
 }
 
+/*
+ * -1 if the dist is not considered
+ */
+int RateModel::get_dist_int(const vector<int> & dist){
+	return distsindex(dist);
+}
+
+/*
+ * same as above, except for tip dists included more than once
+ */
+int RateModel::get_first_dist_int(const vector<int> & dist){
+	return distsindex.first(dist);
+}
+
 vector<vector<vector<int> > > * RateModel::get_iter_dist_splits(vector<int> & dist){
 	return &iter_dists[dist];
 }
@@ -1094,6 +1092,37 @@ vector<vector<vector<int> > > * RateModel::get_iter_dist_splits_per_period(vecto
 	return &iter_dists_per_period[dist][period];
 }
 
+vector<vector<vector<int> > > * RateModel::get_iter_dist_splits_per_period(int dist, int period){
+	return &(*iter_dists_per_period_int[dist])[period];
+}
+
+const cladogenesis::Splits & RateModel::get_splits_per_period(int period){
+	return splits_per_period[period];
+}
+
+/*
+ * sum over the splits of dist of v1[left]*v2[right], weighted
+ */
+template <typename Scalar>
+Scalar RateModel::get_split_likelihood(int dist, int period, vector<Scalar> & v1, vector<Scalar> & v2){
+	return splits_per_period[period].likelihood(dist, v1, v2);
+}
+
+/*
+ * transpose of the above: a[left] += factor*weight*v2[right] over the splits of dist
+ */
+template <typename Scalar>
+void RateModel::add_split_reverse(int dist, int period, Scalar factor, vector<Scalar> & v2, vector<Scalar> & a){
+	splits_per_period[period].add_left(dist, factor, v2, a);
+}
+
+template Superdouble RateModel::get_split_likelihood(int, int, vector<Superdouble> &, vector<Superdouble> &);
+template long double RateModel::get_split_likelihood(int, int, vector<long double> &, vector<long double> &);
+template double RateModel::get_split_likelihood(int, int, vector<double> &, vector<double> &);
+template void RateModel::add_split_reverse(int, int, Superdouble, vector<Superdouble> &, vector<Superdouble> &);
+template void RateModel::add_split_reverse(int, int, long double, vector<long double> &, vector<long double> &);
+template void RateModel::add_split_reverse(int, int, double, vector<double> &, vector<double> &);
+
 vector<vector<int> > * RateModel::get_incldists_per_period(int period)
 {
 	return &incldists_per_period[period];
@@ -1118,7 +1147,7 @@ int RateModel::get_num_areas(){return nareas;}
 
 int RateModel::get_num_periods(){return periods.size();}
 
-vector< vector< vector<double> > > & RateModel::get_Q(){
+vector<matrix::Matrix> & RateModel::get_Q(){
 	return Q;
 }
 
@@ -10,9 +10,16 @@
 
 
 //#include "AncSplit.h"
+#include "banded_q.hpp"
+#include "cladogenesis.hpp"
+#include "matrix.hpp"
+#include "model_cache.hpp"
+#include "pade.hpp"
+#include "range_index.hpp"
 
 #include <vector>
 #include <map>
+#include <set>
 #include <string>
 using namespace std;
 
@@ -42,24 +49,67 @@ private:
 	vector<vector<int> > incldistsint_per_period;
 	vector<vector<vector<int> > > excldists_per_period;
 	map<vector<int>, map<int,vector<vector<vector<int> > > > > iter_dists_per_period;
+	//	same as above, by dist int
+	vector<map<int,vector<vector<vector<int> > > > *> iter_dists_per_period_int;
+	//	same splits, grouped by form for computing node likelihoods
+	vector<cladogenesis::Splits> splits_per_period;
+	//	dist int of any dist, and its position within incldists_per_period (-1 when excluded)
+	range_index::Index distsindex;
+	vector<vector<int> > incldistspos_per_period;
+	void index_dists();
+	bool is_incldist(vector<int> & dist, int period);
 
 	map<int,string> areanamemaprev;
 	map<vector<int>,vector<vector<vector<int> > > > iter_dists;
 	map<vector<int>,string> distsmap;
 	map<vector<int>, int> distsintmap;
 	map<int,vector<int> > intdistsmap;
-	vector< vector< vector<double> > >D;
-	vector< vector< vector<double> > >Dmask;
-	vector< vector<double> > E;
-	vector< vector< vector<double> > >Q;
-	vector< vector< vector<double> > >QT;//transposed for sparse
-	vector< vector< vector<double> > >P;
-	vector<int> nzs;
-	vector<vector<int> > ia_s;
-	vector<vector<int> > ja_s;
-	vector<vector<double> > a_s;
+	vector<matrix::Matrix> D;
+	vector<matrix::Matrix> Dmask;
+	matrix::Matrix E;
+	vector<matrix::Matrix> Q;
+	//	P of the last exponential in each period, when not stored
+	vector<matrix::Matrix> P;
+	//	Q sorted by range size, to propagate without forming P
+	vector<banded_q::Matrix> Q_banded;
+	//	bumped whenever Q[period] actually changes, so that likelihood evaluations
+	//	only recompute the branches going through the periods that changed
+	vector<unsigned long> Q_versions;
+	void commit_Q(int period, const matrix::Matrix & previous, vector<vector<int> > & ranges);
+	//	exp_action specialized for the number of ranges, chosen in setup_dists
+	banded_q::Action P_action;
+	//	reused by every dense exponential
+	pade::Workspace pade_workspace;
+	void setup_Q_banded(int period, vector<vector<int> > & ranges);
 	void iter_all_dist_splits();
 	void iter_all_dist_splits_per_period();
+	//	ranges whose splits need recomputing after tip ranges were included
+	set<vector<int> > stale_splits;
+
+	/*
+	 * sparsity pattern of Q, independent of the D and E values:
+	 * for each period, the cells to fill (in order), each one summing
+	 * the terms Q_terms[period][first .. last)
+	 */
+	struct Qterm {
+		int src;	//	dispersal D[period][src][dest], or extinction E[period][dest] if negative
+		int dest;
+	};
+	struct Qcell {
+		int row;
+		int col;
+		int first;
+		int last;
+	};
+	vector<vector<Qcell> > Q_cells;
+	vector<vector<Qterm> > Q_terms;
+	vector<size_t> Q_pattern_extent;	//	number of incldists covered in each period
+	void setup_Q_pattern();
+	void setup_Q_pattern(int period, size_t from);
+
+	friend model_cache::Key model_cache::key(const RateModel & rm);
+	friend bool model_cache::load(const string & path, RateModel & rm, vector<vector<int> > & rangemap);
+	friend void model_cache::save(const string & path, const RateModel & rm, const vector<vector<int> > & rangemap);
 
 public:
 	RateModel(int na, bool ge, vector<double> pers, bool sp, bool cv, bool ra);
@@ -70,6 +120,7 @@ public:
 	void setup_adjacency(vector<vector<vector<bool>>>);
 	void set_adj_bool(bool adjBool);
 	vector< vector<int> > generate_adjacent_dists(int maxareas, map<int,string> areanamemaprev);
+	vector< vector<int> > generate_cached_adjacent_dists(int maxareas, map<int,string> areanamemaprev, const string & cachefile);
 	vector< vector<int> >  iterate_all_from_num_max_areas(int m, int n);
 	void include_tip_dists(map<string,vector<int> > distrib_data, vector<vector<int> > &includedists, map<int,string> areanamemaprev);
 	void setup_Dmask();
@@ -77,13 +128,15 @@ public:
 	void set_Dmask_cell(int period, int area, int area2, double prob, bool sym);
 	void setup_D(double d);
 	void setup_E(double e);
+	void set_D_period(int period, double d);
+	void set_E_period(int period, double e);
 	void set_Qdiag(int period);
 	void setup_Q();
 	void set_Qdiag_with_adjacency(int period);
 	void setup_Q_with_adjacency();
-	vector<vector<double > > setup_fortran_P(int period, double t, bool store_p_matrices);
-	vector<vector<double > > setup_sparse_full_P(int period, double t);
-	vector<double > setup_sparse_single_column_P(int period, double t, int column);
+	matrix::View setup_pade_P(int period, double t, bool store_p_matrices);
+	static void pade_P(const matrix::Matrix & q, double t, pade::Workspace & ws, matrix::Matrix & p);
+	void setup_P_action(int period, double t, vector<double> & v);
 //	vector<vector<double > > setup_pthread_sparse_P(int period, double t, vector<int> & columns);
 	string Q_repr(int period);
 	string P_repr(int period);
@@ -94,8 +147,16 @@ public:
 	vector<vector<int> > * getDists();
 	map<vector<int>,int> * get_dists_int_map();
 	map<int,vector<int> > * get_int_dists_map();
+	int get_dist_int(const vector<int> & dist);
+	int get_first_dist_int(const vector<int> & dist);
 	vector<vector<vector<int> > > * get_iter_dist_splits(vector<int> & dist);
 	vector<vector<vector<int> > > * get_iter_dist_splits_per_period(vector<int> & dist, int period);
+	vector<vector<vector<int> > > * get_iter_dist_splits_per_period(int dist, int period);
+	const cladogenesis::Splits & get_splits_per_period(int period);
+	template <typename Scalar>
+	Scalar get_split_likelihood(int dist, int period, vector<Scalar> & v1, vector<Scalar> & v2);
+	template <typename Scalar>
+	void add_split_reverse(int dist, int period, Scalar factor, vector<Scalar> & v2, vector<Scalar> & a);
 	vector<vector<int> > * get_incldists_per_period(int period);
 	vector<int> * get_incldistsint_per_period(int period);
 	vector<vector<int> > * get_excldists_per_period(int period);
@@ -109,12 +170,13 @@ public:
 	 map of period and map of bl and p matrix
 	 map<period,map<branch length,p matrix>>
 	 */
-	map<int,map<double, vector<vector<double> > > > stored_p_matrices;
+	map<int,map<double, matrix::Matrix> > stored_p_matrices;
 
 	/*
 	 * get things from stmap
 	 */
-	vector< vector< vector<double> > > & get_Q();
+	vector<matrix::Matrix> & get_Q();
+	unsigned long get_Q_version(int period);
 	//this should be used for getting the eigenvectors and eigenvalues
 //	bool get_eigenvec_eigenval_from_Q(cx_mat * eigenvalues, cx_mat * eigenvectors, int period);
 	//bool get_eigenvec_eigenval_from_Q_octave(ComplexMatrix * eigenvalues, ComplexMatrix * eigenvectors, int period);
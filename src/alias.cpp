@@ -0,0 +1,57 @@
+#include "alias.hpp"
+
+namespace alias {
+
+Table::Table(const double* weights, const int n) {
+  double total{0};
+  int heaviest{0};
+  for (int i{0}; i < n; ++i) {
+    total += weights[i];
+    if (weights[i] > weights[heaviest]) {
+      heaviest = i;
+    }
+  }
+  if (!(total > 0)) {
+    return;
+  }
+  probability.resize(n);
+  alias.resize(n);
+  std::vector<double> scaled(n);
+  std::vector<int> small, large;
+  for (int i{0}; i < n; ++i) {
+    scaled[i] = weights[i] * n / total;
+    (scaled[i] < 1 ? small : large).push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    const int s{small.back()};
+    const int l{large.back()};
+    small.pop_back();
+    large.pop_back();
+    probability[s] = scaled[s];
+    alias[s] = l;
+    scaled[l] = (scaled[l] + scaled[s]) - 1;
+    (scaled[l] < 1 ? small : large).push_back(l);
+  }
+  // Whatever is left is full up to rounding,
+  // save entries of weight 0, which go to the heaviest one.
+  for (const int l : large) {
+    probability[l] = 1;
+    alias[l] = l;
+  }
+  for (const int s : small) {
+    probability[s] = weights[s] > 0 ? 1 : 0;
+    alias[s] = weights[s] > 0 ? s : heaviest;
+  }
+}
+
+int Table::draw(const double u) const {
+  const int n{static_cast<int>(probability.size())};
+  const double x{u * n};
+  int column{static_cast<int>(x)};
+  if (column >= n) {
+    column = n - 1;
+  }
+  return x - column < probability[column] ? column : alias[column];
+}
+
+} // namespace alias
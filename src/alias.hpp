@@ -0,0 +1,30 @@
+#pragma once
+
+// Walker's alias method, for drawing from a fixed discrete distribution
+// in O(1) per draw after an O(n) construction (Vose's version):
+// every one of the n columns holds a share 'probability' of itself,
+// and the rest of the column goes to its 'alias'.
+// A single uniform number in [0, 1) picks both the column and the side.
+
+#include <vector>
+
+namespace alias {
+
+class Table {
+  std::vector<double> probability;
+  std::vector<int> alias;
+
+public:
+  Table() = default;
+  // From n non-negative weights, which need not sum to 1.
+  // Entries of weight 0 are never drawn.
+  // The table is empty if all weights are 0.
+  Table(const double* weights, int n);
+
+  bool empty() const { return probability.empty(); }
+
+  // Entry drawn from u, uniform in [0, 1).
+  int draw(double u) const;
+};
+
+} // namespace alias
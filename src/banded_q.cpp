@@ -0,0 +1,184 @@
+#include "banded_q.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace banded_q {
+
+// Uniformization splits t so that rate·t is at most this on every step
+// (keeping the first Poisson weight exp(-rate·t) far from underflow).
+constexpr double MAX_STEP{100};
+// Truncate the Poisson series once the remaining weight is below this.
+constexpr double TOLERANCE{1e-16};
+
+Matrix::Matrix(const matrix::Matrix& Q, const std::vector<int>& sizes) {
+  const int n{static_cast<int>(sizes.size())};
+  const int n_classes{n > 0 ? *std::max_element(sizes.begin(), sizes.end()) + 1
+                            : 0};
+
+  // Counting sort, stable.
+  class_starts.assign(n_classes + 1, 0);
+  for (const int size : sizes) {
+    ++class_starts[size + 1];
+  }
+  for (int c{0}; c < n_classes; ++c) {
+    class_starts[c + 1] += class_starts[c];
+  }
+  order.resize(n);
+  position.resize(n);
+  std::vector<int> next{class_starts.begin(), class_starts.end() - 1};
+  for (int i{0}; i < n; ++i) {
+    position[i] = next[sizes[i]]++;
+    order[position[i]] = i;
+  }
+
+  // Any rate ≥ |Q_ii| works, the smallest one needs the fewest products.
+  for (int i{0}; i < n; ++i) {
+    double off_diagonal{0};
+    for (int j{0}; j < n; ++j) {
+      if (j != i) {
+        off_diagonal += std::abs(Q[i][j]);
+      }
+    }
+    rate = std::max({rate, std::abs(Q[i][i]), off_diagonal});
+  }
+  if (rate == 0) {
+    return;
+  }
+
+  row_starts.reserve(n + 1);
+  row_starts.push_back(0);
+  for (int r{0}; r < n; ++r) {
+    const int i{order[r]};
+    for (int j{0}; j < n; ++j) {
+      if (j == i) {
+        columns.push_back(r);
+        values.push_back(1 + Q[i][i] / rate);
+      } else if (Q[i][j] != 0) {
+        columns.push_back(position[j]);
+        values.push_back(Q[i][j] / rate);
+        band = std::max(band, std::abs(sizes[i] - sizes[j]));
+      }
+    }
+    row_starts.push_back(static_cast<int>(columns.size()));
+  }
+}
+
+namespace {
+
+// Buffers of exp_action: on the stack when the order is bounded
+// at compile time, allocated otherwise.
+template <int N> struct Buffers {
+  std::array<double, N> sum{}, term{}, product{};
+  explicit Buffers(int) {}
+};
+
+template <> struct Buffers<0> {
+  std::vector<double> sum, term, product;
+  explicit Buffers(const int n) : sum(n), term(n), product(n) {}
+};
+
+} // namespace
+
+void Matrix::exp_action(const double t, std::vector<double>& v) const {
+  exp_action<0>(t, v);
+}
+
+template <int N>
+void Matrix::exp_action(const double t, std::vector<double>& v) const {
+  const int n{static_cast<int>(order.size())};
+  const double rt{rate * t};
+  if (rt == 0) {
+    return;
+  }
+  if (!std::isfinite(rt)) {
+    std::fill(v.begin(), v.end(), std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+  const int n_classes{static_cast<int>(class_starts.size()) - 1};
+
+  // Work in sorted positions.
+  Buffers<N> buffers{n};
+  double* sum{buffers.sum.data()};
+  double* term{buffers.term.data()};
+  double* product{buffers.product.data()};
+  for (int r{0}; r < n; ++r) {
+    sum[r] = v[order[r]];
+  }
+
+  const int n_steps{static_cast<int>(std::ceil(rt / MAX_STEP))};
+  const double lambda{rt / n_steps};
+  for (int step{0}; step < n_steps; ++step) {
+    // Size classes holding nonzero entries so far.
+    int lo{n_classes}, hi{-1};
+    for (int c{0}; c < n_classes; ++c) {
+      for (int r{class_starts[c]}; r < class_starts[c + 1]; ++r) {
+        if (sum[r] != 0) {
+          lo = std::min(lo, c);
+          hi = c;
+          break;
+        }
+      }
+    }
+    if (hi < 0) {
+      break;
+    }
+
+    // sum = Σ_k Poisson(k; lambda) · B^k · v
+    std::copy(sum, sum + n, term);
+    std::fill(product, product + n, 0);
+    double weight{std::exp(-lambda)};
+    for (int r{class_starts[lo]}; r < class_starts[hi + 1]; ++r) {
+      sum[r] *= weight;
+    }
+    for (int k{1};; ++k) {
+      lo = std::max(lo - band, 0);
+      hi = std::min(hi + band, n_classes - 1);
+      const int first{class_starts[lo]}, last{class_starts[hi + 1]};
+      for (int r{first}; r < last; ++r) {
+        double s{0};
+        for (int e{row_starts[r]}; e < row_starts[r + 1]; ++e) {
+          s += values[e] * term[columns[e]];
+        }
+        product[r] = s;
+      }
+      // Rows outside [first, last) are zero in both.
+      std::swap(term, product);
+      weight *= lambda / k;
+      for (int r{first}; r < last; ++r) {
+        sum[r] += weight * term[r];
+      }
+      if (k > lambda && weight * (k + 1) / (k + 1 - lambda) < TOLERANCE) {
+        break;
+      }
+    }
+  }
+
+  for (int r{0}; r < n; ++r) {
+    v[order[r]] = sum[r];
+  }
+}
+
+Action action_for(const int n) {
+  // Every range count up to 8 areas.
+  if (n <= 16) {
+    return &Matrix::exp_action<16>;
+  }
+  if (n <= 32) {
+    return &Matrix::exp_action<32>;
+  }
+  if (n <= 64) {
+    return &Matrix::exp_action<64>;
+  }
+  if (n <= 128) {
+    return &Matrix::exp_action<128>;
+  }
+  if (n <= 256) {
+    return &Matrix::exp_action<256>;
+  }
+  return &Matrix::exp_action<0>;
+}
+
+} // namespace banded_q
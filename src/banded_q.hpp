@@ -0,0 +1,58 @@
+#pragma once
+
+// Sparse storage of a period's rate matrix Q, exploiting its structure:
+// a range of size k only ever turns into a range of size k ± 1
+// (or k ± 2 with 'rapid_anagenesis'),
+// so with ranges sorted by size, Q is block-tridiagonal
+// (resp. block-pentadiagonal), and each block is itself sparse.
+//
+// This is used to propagate conditional likelihoods along branch segments
+// as the action of the matrix exponential exp(tQ)·v,
+// instead of forming the dense P = exp(tQ) and multiplying with it.
+// Uniformization only needs products with Q,
+// and each of them is restricted to the size classes
+// reachable so far from the nonzero entries of v.
+// Up to 256 ranges (8 areas), the number of ranges is also bounded
+// at compile time, which spares any allocation along the way.
+
+#include "matrix.hpp"
+
+#include <vector>
+
+namespace banded_q {
+
+class Matrix {
+  // Ranges sorted by size, and the position of each one in this order.
+  std::vector<int> order;
+  std::vector<int> position;
+  // First sorted position of every size class (plus the end).
+  std::vector<int> class_starts;
+  // Greatest size difference between two ranges connected in Q.
+  int band{0};
+  // Uniformized matrix B = I + Q / rate, as compressed sparse rows
+  // in sorted positions.
+  double rate{0};
+  std::vector<int> row_starts;
+  std::vector<int> columns;
+  std::vector<double> values;
+
+public:
+  Matrix() = default;
+  // Read Q (dense, square) given the size of every range.
+  Matrix(const matrix::Matrix& Q, const std::vector<int>& sizes);
+
+  // Overwrite v with exp(tQ)·v.
+  void exp_action(double t, std::vector<double>& v) const;
+
+  // Same, for at most N ranges, with the work vectors on the stack
+  // (N = 0: any number, as above).
+  template <int N> void exp_action(double t, std::vector<double>& v) const;
+};
+
+using Action = void (Matrix::*)(double, std::vector<double>&) const;
+
+// The exp_action for the smallest order N holding n ranges, if any:
+// to choose once per model.
+Action action_for(int n);
+
+} // namespace banded_q
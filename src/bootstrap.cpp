@@ -0,0 +1,142 @@
+#include "bootstrap.hpp"
+
+#include "OptimizeBioGeo.h"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace bootstrap {
+
+Bootstrap::Bootstrap(Tree& tree, RateModel& model,
+                     replica::Analysis analysis)
+    : tree{tree}, model{model}, analysis{std::move(analysis)} {}
+
+void Bootstrap::analyse(replica::Replica& worker,
+                        const simulation::Replicate& replicate,
+                        Estimate& estimate) const {
+  estimate.number = replicate.number;
+  estimate.seed = replicate.seed;
+  std::vector<std::vector<int>>& dists{*worker.model().getDists()};
+  std::map<std::string, std::vector<int>> tips;
+  const std::vector<Node*>& nodes{worker.nodes()};
+  for (size_t s{0}; s < nodes.size(); ++s) {
+    if (nodes[s]->isExternal()) {
+      if (replicate.ranges[s] <= 0) {
+        return;
+      }
+      tips[nodes[s]->getName()] = dists[replicate.ranges[s]];
+    }
+  }
+  BioGeoTree& bgt{worker.bgt()};
+  bgt.set_tip_conditionals(tips);
+
+  OptimizeBioGeo opt(&bgt, &worker.model(), analysis.marginal,
+                     analysis.max_iterations, analysis.stopping_precision);
+  const std::vector<double> rates{opt.optimize_global_dispersal_extinction(
+      analysis.start.dispersal, analysis.start.extinction)};
+  estimate.rates = simulation::Rates{rates[0], rates[1]};
+  worker.model().setup_D(rates[0]);
+  worker.model().setup_E(rates[1]);
+  worker.model().setup_Q_with_adjacency();
+  bgt.update_default_model(&worker.model());
+  bgt.set_store_p_matrices(true);
+  estimate.likelihood = double(bgt.eval_likelihood(analysis.marginal));
+  bgt.set_store_p_matrices(false);
+
+  // Most likely range at every internal node, against the simulated one.
+  bgt.prepare_ancstate_reverse();
+  int internal{0};
+  int correct{0};
+  for (size_t s{0}; s < nodes.size(); ++s) {
+    Node& node{*nodes[s]};
+    if (node.isExternal()) {
+      continue;
+    }
+    const std::vector<Superdouble> states{
+        bgt.calculate_ancstate_reverse(node, analysis.marginal)};
+    int best{-1};
+    for (size_t i{0}; i < states.size(); ++i) {
+      if (states[i] > Superdouble(0) &&
+          (best < 0 || states[i] > states[best])) {
+        best = i;
+      }
+    }
+    ++internal;
+    correct += best == replicate.ranges[s];
+  }
+  estimate.correct = double(correct) / internal;
+  estimate.analysed = true;
+}
+
+Summary Bootstrap::run(const int replicates, const unsigned long seed,
+                       const simulation::Rates& fitted,
+                       unsigned int n_threads,
+                       const std::function<void(const Estimate&)>& write) {
+  if (n_threads == 0) {
+    n_threads = parallel::default_threads();
+  }
+  std::vector<simulation::Engine> engines;
+  engines.emplace_back(tree, model);
+
+  // Set up one after the other, each one then kept by a thread.
+  const int block{256};
+  std::vector<std::unique_ptr<replica::Replica>> workers(
+      std::min<int>(n_threads, std::min(block, replicates)));
+  for (auto& w : workers) {
+    w.reset(new replica::Replica(tree, model, analysis.periods,
+                                 analysis.scalar_type));
+    w->constrain(tree, true);
+  }
+
+  Summary summary;
+  simulation::Rates squares{0, 0};
+  double correct{0};
+  std::vector<Estimate> estimates(block);
+  for (int first{0}; first < replicates; first += block) {
+    const int n{std::min(block, replicates - first)};
+    const std::vector<simulation::Replicate> drawn{simulation::run(
+        engines, replicates, first, n, seed, fitted, n_threads)};
+    std::atomic<int> next{0};
+    parallel::for_each_index(workers.size(), workers.size(), [&](size_t w) {
+      for (int i{next++}; i < n; i = next++) {
+        estimates[i] = Estimate{};
+        analyse(*workers[w], drawn[i], estimates[i]);
+      }
+    });
+    for (int i{0}; i < n; ++i) {
+      const Estimate& estimate{estimates[i]};
+      write(estimate);
+      if (!estimate.analysed) {
+        continue;
+      }
+      ++summary.analysed;
+      summary.mean.dispersal += estimate.rates.dispersal;
+      summary.mean.extinction += estimate.rates.extinction;
+      squares.dispersal += estimate.rates.dispersal * estimate.rates.dispersal;
+      squares.extinction += estimate.rates.extinction * estimate.rates.extinction;
+      correct += estimate.correct;
+    }
+  }
+
+  if (summary.analysed > 0) {
+    const double k{double(summary.analysed)};
+    summary.mean.dispersal /= k;
+    summary.mean.extinction /= k;
+    summary.sd.dispersal = std::sqrt(std::max(
+        0.0, squares.dispersal / k -
+                 summary.mean.dispersal * summary.mean.dispersal));
+    summary.sd.extinction = std::sqrt(std::max(
+        0.0, squares.extinction / k -
+                 summary.mean.extinction * summary.mean.extinction));
+    summary.correct = correct / k;
+  }
+  return summary;
+}
+
+} // namespace bootstrap
@@ -0,0 +1,76 @@
+#pragma once
+
+// Parametric bootstrap of the dispersal and extinction rates:
+// datasets simulated under the fitted rates on the tree analysed
+// (see simulation.hpp), each one analysed as the data were,
+// the rates estimated again (simplex) from the same starting values,
+// then the ancestral ranges reconstructed and checked against
+// the simulated ones.
+//
+// Replicates are simulated a block at a time, then analysed in parallel
+// by workers holding their own copy of the tree and of the model
+// (see replica.hpp). The simulation only honours the ranges excluded
+// at the root, so those are the only node constraints the replicates
+// are analysed with (no other fixed node, nor fossils).
+//
+// Replicate k is simulated from its own generator, seeded with seed + k - 1,
+// and estimates are handed over in replicate order,
+// so that results do not depend on the number of threads.
+
+#include "BioGeoTree.h"
+#include "RateModel.h"
+#include "replica.hpp"
+#include "simulation.hpp"
+#include "tree.h"
+
+#include <functional>
+#include <vector>
+
+namespace bootstrap {
+
+// Outcome of one replicate.
+struct Estimate {
+  // Replicate number, from 1.
+  int number{0};
+  unsigned long seed{0};
+  // Not when a tip was left without any range to start from.
+  bool analysed{false};
+  simulation::Rates rates{0, 0};
+  // -ln likelihood at the estimated rates.
+  double likelihood{0};
+  // Fraction of the internal nodes whose most likely range
+  // is the simulated one.
+  double correct{0};
+};
+
+// Over the replicates analysed.
+struct Summary {
+  int analysed{0};
+  simulation::Rates mean{0, 0};
+  simulation::Rates sd{0, 0};
+  double correct{0};
+};
+
+class Bootstrap {
+  Tree& tree;
+  RateModel& model;
+  const replica::Analysis analysis;
+
+  void analyse(replica::Replica& worker,
+               const simulation::Replicate& replicate,
+               Estimate& estimate) const;
+
+public:
+  // Once the data are analysed: the tree and the model
+  // (set up for the likelihood) must outlive the bootstrap.
+  Bootstrap(Tree& tree, RateModel& model, replica::Analysis analysis);
+
+  // Replicates 1 .. replicates under the fitted rates,
+  // to which the model is set for the simulation,
+  // each estimate handed to write as soon as its block is done.
+  Summary run(int replicates, unsigned long seed,
+              const simulation::Rates& fitted, unsigned int n_threads,
+              const std::function<void(const Estimate&)>& write);
+};
+
+} // namespace bootstrap
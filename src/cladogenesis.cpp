@@ -0,0 +1,88 @@
+#include "cladogenesis.hpp"
+
+namespace cladogenesis {
+
+void Splits::add(const int range, const int left, const bool left_single,
+                 const int right, const bool right_single) {
+  Range& r{ranges[range]};
+  if (r.n_splits++ == 0) {
+    r.first = size();
+  }
+  flat_range.push_back(range);
+  flat_left.push_back(left);
+  flat_right.push_back(right);
+  if (right == range && left != range && left_single) {
+    r.left_areas.push_back(left);
+  } else if (left == range && right != range && right_single) {
+    r.right_areas.push_back(right);
+  } else {
+    r.left.push_back(left);
+    r.right.push_back(right);
+  }
+}
+
+template <typename Scalar>
+Scalar Splits::likelihood(const int range, std::vector<Scalar>& v1,
+                          std::vector<Scalar>& v2) const {
+  const Range& r{ranges[range]};
+  Scalar lh(0);
+  if (r.n_splits == 0) {
+    return lh;
+  }
+  if (!r.left_areas.empty()) {
+    Scalar sum(0);
+    for (const int area : r.left_areas) {
+      sum += v1[area];
+    }
+    lh += v2[range] * sum;
+  }
+  if (!r.right_areas.empty()) {
+    Scalar sum(0);
+    for (const int area : r.right_areas) {
+      sum += v2[area];
+    }
+    lh += v1[range] * sum;
+  }
+  for (size_t k{0}; k < r.left.size(); ++k) {
+    lh += v1[r.left[k]] * v2[r.right[k]];
+  }
+  return lh * (1.0 / r.n_splits);
+}
+
+template <typename Scalar>
+void Splits::add_left(const int range, Scalar factor, std::vector<Scalar>& v2,
+                      std::vector<Scalar>& a) const {
+  const Range& r{ranges[range]};
+  if (r.n_splits == 0) {
+    return;
+  }
+  Scalar f{factor * (1.0 / r.n_splits)};
+  for (const int area : r.left_areas) {
+    a[area] += v2[range] * f;
+  }
+  if (!r.right_areas.empty()) {
+    Scalar sum(0);
+    for (const int area : r.right_areas) {
+      sum += v2[area];
+    }
+    a[range] += sum * f;
+  }
+  for (size_t k{0}; k < r.left.size(); ++k) {
+    a[r.left[k]] += v2[r.right[k]] * f;
+  }
+}
+
+template Superdouble Splits::likelihood(int, std::vector<Superdouble>&,
+                                        std::vector<Superdouble>&) const;
+template long double Splits::likelihood(int, std::vector<long double>&,
+                                        std::vector<long double>&) const;
+template double Splits::likelihood(int, std::vector<double>&,
+                                   std::vector<double>&) const;
+template void Splits::add_left(int, Superdouble, std::vector<Superdouble>&,
+                               std::vector<Superdouble>&) const;
+template void Splits::add_left(int, long double, std::vector<long double>&,
+                               std::vector<long double>&) const;
+template void Splits::add_left(int, double, std::vector<double>&,
+                               std::vector<double>&) const;
+
+} // namespace cladogenesis
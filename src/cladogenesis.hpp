@@ -0,0 +1,78 @@
+#pragma once
+
+// Likelihood of every ancestral range at a node,
+// given the conditionals of the two descendant branches:
+//
+//   L(range) = 1/n · Σ_{(left, right) in splits(range)} v1[left]·v2[right]
+//
+// Most splits keep the whole range on one side
+// and a single area of it on the other (widespread and subset sympatry),
+// so these are factored out of the sum:
+//
+//   Σ_a v1[a]·v2[range] = v2[range] · Σ_a v1[a]
+//
+// which leaves one product per range and side,
+// plus one per remaining split (vicariance, and sympatry within one area).
+// The splits themselves are those of RateModel::iter_dist_splits_per_period,
+// grouped once per period.
+// They are also kept flat, in the order they were added,
+// for reconstructing splits one by one: split k of the table
+// divides range_of(k) into left_of(k) and right_of(k).
+
+#include "superdouble.h"
+
+#include <vector>
+
+namespace cladogenesis {
+
+class Splits {
+  struct Range {
+    int n_splits{0};
+    // Position of the first split in the flat table.
+    int first{0};
+    // Single areas a splitting off as (a, range).
+    std::vector<int> left_areas;
+    // Single areas a splitting off as (range, a).
+    std::vector<int> right_areas;
+    // Any other split (left, right).
+    std::vector<int> left;
+    std::vector<int> right;
+  };
+  std::vector<Range> ranges;
+  std::vector<int> flat_range;
+  std::vector<int> flat_left;
+  std::vector<int> flat_right;
+
+public:
+  Splits() = default;
+  explicit Splits(int n_ranges) : ranges(n_ranges) {}
+
+  // Record the split of 'range' into 'left' and 'right',
+  // telling which sides are a single area.
+  // All splits of a range are added together.
+  void add(int range, int left, bool left_single, int right,
+           bool right_single);
+
+  // Flat table.
+  int size() const { return static_cast<int>(flat_range.size()); }
+  int range_of(int k) const { return flat_range[k]; }
+  int left_of(int k) const { return flat_left[k]; }
+  int right_of(int k) const { return flat_right[k]; }
+  // Splits of 'range' are [first(range), first(range) + n_splits(range)).
+  int first(int range) const { return ranges[range].first; }
+  int n_splits(int range) const { return ranges[range].n_splits; }
+
+  // L(range) given the descendant conditionals (0 if the range has no split),
+  // for each numeric type of the likelihood engine (see scalar.hpp).
+  template <typename Scalar>
+  Scalar likelihood(int range, std::vector<Scalar>& v1,
+                    std::vector<Scalar>& v2) const;
+
+  // Transpose, for the reverse pass: add factor/n · v2[right] to a[left]
+  // for every split of 'range'.
+  template <typename Scalar>
+  void add_left(int range, Scalar factor, std::vector<Scalar>& v2,
+                std::vector<Scalar>& a) const;
+};
+
+} // namespace cladogenesis
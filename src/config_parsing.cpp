@@ -192,6 +192,14 @@ std::optional<File> Reader::seek_file(Name name, const bool descend) {
   return {};
 };
 
+std::optional<File> Reader::seek_path(Name name, const bool descend) {
+  const auto& filename{seek_string(name, descend)};
+  if (filename.has_value()) {
+    return {{*filename, folder / *filename}};
+  }
+  return {};
+};
+
 std::optional<Table> Reader::seek_table(Name name, const bool descend) {
   auto node{seek_node(name, {toml::node_type::table}, descend)};
   if (node.has_value()) {
@@ -252,6 +260,60 @@ ReportType Reader::read_report_type() {
   return result;
 }
 
+std::optional<scalar::Type> Reader::read_scalar_type() {
+  auto string{seek_string("scalar", true)};
+  if (!string.has_value()) {
+    return {};
+  }
+  auto result{scalar::parse(*string)};
+  if (!result.has_value()) {
+    std::cerr << "Unknown scalar type: '" << *string << "'. ";
+    std::cerr << "Supported types are " << scalar::NAMES << "." << std::endl;
+    source_and_exit();
+  }
+  step_up();
+  return result;
+}
+
+RatesMode Reader::read_rates_mode() {
+  auto string{seek_string("rates", true)};
+  if (!string.has_value()) {
+    return RatesMode::Global;
+  }
+  RatesMode result;
+  if (*string == "global") {
+    result = RatesMode::Global;
+  } else if (*string == "per_period") {
+    result = RatesMode::PerPeriod;
+  } else {
+    std::cerr << "Unknown rates mode: '" << *string << "'. ";
+    std::cerr << "Supported modes are 'global' and 'per_period'." << std::endl;
+    source_and_exit();
+  }
+  step_up();
+  return result;
+}
+
+SimulationOutput Reader::read_simulation_output() {
+  auto string{seek_string("output", true)};
+  if (!string.has_value()) {
+    return SimulationOutput::PerReplicate;
+  }
+  SimulationOutput result;
+  if (*string == "per_replicate") {
+    result = SimulationOutput::PerReplicate;
+  } else if (*string == "combined") {
+    result = SimulationOutput::Combined;
+  } else {
+    std::cerr << "Unknown simulation output: '" << *string << "'. ";
+    std::cerr << "Supported outputs are 'per_replicate' and 'combined'."
+              << std::endl;
+    source_and_exit();
+  }
+  step_up();
+  return result;
+}
+
 std::vector<double> Reader::read_periods() {
   bool dates{false};
   auto node{seek_node("periods", {toml::node_type::array}, true)};
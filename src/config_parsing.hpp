@@ -5,6 +5,7 @@
 // and handle errors.
 
 #include "lexer.hpp"
+#include "scalar.hpp"
 
 #include <filesystem>
 #include <functional>
@@ -32,6 +33,20 @@ enum class ReportType {
   Splits,
 };
 
+// Rates estimated by the optimizer:
+// one dispersal and one extinction rate overall, or one of each per period.
+enum class RatesMode {
+  Global,
+  PerPeriod,
+};
+
+// Files simulated replicates are written to:
+// three of their own for each, or three for all of them.
+enum class SimulationOutput {
+  PerReplicate,
+  Combined,
+};
+
 // Lighten verbosity of the types used in this namespace.
 using View = toml::node_view<const toml::node>;
 using Type = toml::node_type;
@@ -157,6 +172,8 @@ public:
   // Same logic with optional nodes. = = = = = = = = = = = = =
   std::optional<bool> seek_bool(Name name, const bool descend);
   std::optional<File> seek_file(Name name, const bool descend);
+  // Same as above, but the file needs not exist yet (eg. for writing).
+  std::optional<File> seek_path(Name name, const bool descend);
   std::optional<double> seek_float(Name name, const bool descend);
   std::optional<int> seek_integer(Name name, const bool descend);
   std::optional<std::string> seek_string(Name name, const bool descend);
@@ -167,6 +184,12 @@ public:
   // More sophisticated parameters.
   AncestralState read_ancestral_state();
   ReportType read_report_type();
+  // Optional numeric type for the likelihood engine.
+  std::optional<scalar::Type> read_scalar_type();
+  // Optional, defaults to global rates.
+  RatesMode read_rates_mode();
+  // Optional, defaults to files per replicate.
+  SimulationOutput read_simulation_output();
 
   // Periods are either specified with the 'periods' key = 'durations' key.
   // In this case, each value in the array
@@ -0,0 +1,178 @@
+#include "expectations.hpp"
+
+#include "BranchSegment.h"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+namespace expectations {
+
+namespace {
+
+void preorder(Node& node, std::vector<Node*>& nodes) {
+  nodes.push_back(&node);
+  for (int i{0}; i < node.getChildCount(); ++i) {
+    preorder(node.getChild(i), nodes);
+  }
+}
+
+// Sum over x, y of a[x] M[x][y] c[y].
+double bilinear(const std::vector<double>& a, matrix::View M,
+                const std::vector<double>& c) {
+  double sum{0};
+  for (int x{0}; x < M.rows(); ++x) {
+    if (a[x] == 0) {
+      continue;
+    }
+    const double* Mx{M[x]};
+    double row{0};
+    for (int y{0}; y < M.cols(); ++y) {
+      row += Mx[y] * c[y];
+    }
+    sum += a[x] * row;
+  }
+  return sum;
+}
+
+} // namespace
+
+std::vector<matrix::Matrix> labels(const matrix::Matrix& Q,
+                                   const std::vector<int>& included,
+                                   const std::vector<std::vector<int>>& dists) {
+  const int m{Q.rows()};
+  const int n_areas{static_cast<int>(dists[included[0]].size())};
+  std::vector<matrix::Matrix> L(2 + n_areas, matrix::Matrix(m, m));
+  for (int i{0}; i < m; ++i) {
+    const std::vector<int>& from{dists[included[i]]};
+    for (int j{0}; j < m; ++j) {
+      if (j == i || Q[i][j] == 0) {
+        continue;
+      }
+      const std::vector<int>& to{dists[included[j]]};
+      int gained{0};
+      int lost{0};
+      for (int a{0}; a < n_areas; ++a) {
+        gained += to[a] > from[a];
+        lost += to[a] < from[a];
+      }
+      L[0][i][j] = Q[i][j] * gained;
+      L[1][i][j] = Q[i][j] * lost;
+    }
+    for (int a{0}; a < n_areas; ++a) {
+      L[2 + a][i][i] = from[a];
+    }
+  }
+  return L;
+}
+
+std::vector<matrix::Matrix> integrals(const matrix::Matrix& Q,
+                                      const std::vector<matrix::Matrix>& labels,
+                                      const double t, pade::Workspace& ws) {
+  const int m{Q.rows()};
+  const int n{2 * m};
+  std::vector<matrix::Matrix> I;
+  for (const matrix::Matrix& L : labels) {
+    // [[Q t, L t], [0, Q t]], column-major.
+    double* H{ws.argument(n)};
+    std::fill(H, H + static_cast<size_t>(n) * n, 0.0);
+    for (int i{0}; i < m; ++i) {
+      for (int j{0}; j < m; ++j) {
+        H[j * n + i] = Q[i][j] * t;
+        H[(m + j) * n + m + i] = Q[i][j] * t;
+        H[(m + j) * n + i] = L[i][j] * t;
+      }
+    }
+    const double* exp_H{pade::exp(ws)};
+    matrix::Matrix block(m, m);
+    for (int i{0}; i < m; ++i) {
+      for (int j{0}; j < m; ++j) {
+        block[i][j] = exp_H[(m + j) * n + i];
+      }
+    }
+    I.push_back(std::move(block));
+  }
+  return I;
+}
+
+Summary expected(Tree& tree, BioGeoTree& bgt, RateModel& model,
+                 const unsigned int n_threads) {
+  bgt.prepare_expectations();
+
+  Summary summary;
+  preorder(*tree.getRoot(), summary.nodes);
+  const int n_areas{model.get_num_areas()};
+  summary.dispersals.assign(summary.nodes.size(), 0);
+  summary.extinctions.assign(summary.nodes.size(), 0);
+  summary.dwelling.assign(summary.nodes.size(),
+                          std::vector<double>(n_areas, 0));
+
+  // Every period and duration among the segments, once.
+  std::map<std::pair<int, double>, size_t> index;
+  std::vector<std::pair<int, double>> segments;
+  for (Node* node : summary.nodes) {
+    if (!node->hasParent()) {
+      continue;
+    }
+    for (BranchSegment& segment : *node->getSegVector()) {
+      const std::pair<int, double> key{segment.getPeriod(),
+                                       segment.getDuration()};
+      if (index.emplace(key, segments.size()).second) {
+        segments.push_back(key);
+      }
+    }
+  }
+
+  const std::vector<matrix::Matrix>& Q{model.get_Q()};
+  const std::vector<std::vector<int>>& dists{*model.getDists()};
+  std::vector<std::vector<matrix::Matrix>> L;
+  for (int period{0}; period < model.get_num_periods(); ++period) {
+    L.push_back(labels(Q[period], *model.get_incldistsint_per_period(period),
+                       dists));
+  }
+  std::vector<std::vector<matrix::Matrix>> I(segments.size());
+  parallel::for_each_index(segments.size(), n_threads, [&](size_t k) {
+    pade::Workspace ws;
+    const int period{segments[k].first};
+    I[k] = integrals(Q[period], L[period], segments[k].second, ws);
+  });
+
+  for (size_t s{0}; s < summary.nodes.size(); ++s) {
+    Node& node{*summary.nodes[s]};
+    if (!node.hasParent()) {
+      continue;
+    }
+    std::vector<BranchSegment>& segs{*node.getSegVector()};
+    for (unsigned int ts{0}; ts < segs.size(); ++ts) {
+      const int period{segs[ts].getPeriod()};
+      const double duration{segs[ts].getDuration()};
+      const std::vector<int>& included{
+          *model.get_incldistsint_per_period(period)};
+      const std::vector<double> top{bgt.relative_reverse(node, ts)};
+      const std::vector<double> end{bgt.relative_conditionals(node, ts)};
+      std::vector<double> a(included.size());
+      std::vector<double> c(included.size());
+      for (size_t i{0}; i < included.size(); ++i) {
+        a[i] = top[included[i]];
+        c[i] = end[included[i]];
+      }
+      const double likelihood{
+          bilinear(a, model.stored_p_matrices[period][duration], c)};
+      if (likelihood <= 0) {
+        continue;
+      }
+      const std::vector<matrix::Matrix>& integral{
+          I[index[{period, duration}]]};
+      summary.dispersals[s] += bilinear(a, integral[0], c) / likelihood;
+      summary.extinctions[s] += bilinear(a, integral[1], c) / likelihood;
+      for (int area{0}; area < n_areas; ++area) {
+        summary.dwelling[s][area] +=
+            bilinear(a, integral[2 + area], c) / likelihood;
+      }
+    }
+  }
+  return summary;
+}
+
+} // namespace expectations
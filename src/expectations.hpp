@@ -0,0 +1,57 @@
+#pragma once
+
+// Expected numbers of dispersal and extinction events along the branches,
+// and time spent in each area, given the data, under the rates
+// of the last likelihood evaluation: what stochastic mapping estimates
+// (see stochastic_mapping.hpp), here without sampling.
+//
+// Events and times are counted with a label matrix L, alongside Q:
+// the rate of every transition times the number of areas it gains
+// (dispersals) or loses (extinctions), or the indicator of an area
+// on the diagonal (time spent there). Along a segment of duration t,
+//
+//   E[count] = a' I c / a' P c,  I = int_0^t exp(Q s) L exp(Q (t - s)) ds,
+//
+// with a the reverse conditionals at the top of the segment
+// (see BioGeoTree::prepare_expectations) and c the conditionals at its end.
+// I is the upper right block of exp([[Q, L], [0, Q]] t) (Van Loan, 1978),
+// taken once for every period and duration among the segments of the tree,
+// those in parallel.
+
+#include "BioGeoTree.h"
+#include "RateModel.h"
+#include "matrix.hpp"
+#include "pade.hpp"
+#include "tree.h"
+
+#include <vector>
+
+namespace expectations {
+
+// Expectations for the branch above every node
+// (in preorder, the root's branch left at zero).
+struct Summary {
+  std::vector<Node*> nodes;
+  std::vector<double> dispersals;
+  std::vector<double> extinctions;
+  // Time spent in each area.
+  std::vector<std::vector<double>> dwelling;
+};
+
+// Label matrices of a period, over its included ranges:
+// dispersals, extinctions, then the time in each area.
+std::vector<matrix::Matrix> labels(const matrix::Matrix& Q,
+                                   const std::vector<int>& included,
+                                   const std::vector<std::vector<int>>& dists);
+
+// I for every label, along a segment of duration t.
+std::vector<matrix::Matrix> integrals(const matrix::Matrix& Q,
+                                      const std::vector<matrix::Matrix>& labels,
+                                      double t, pade::Workspace& ws);
+
+// Right after the likelihood evaluation with P matrices stored
+// (see BioGeoTree::set_store_p_matrices).
+Summary expected(Tree& tree, BioGeoTree& bgt, RateModel& model,
+                 unsigned int n_threads);
+
+} // namespace expectations
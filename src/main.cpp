@@ -41,13 +41,58 @@ using namespace std;
 #include "distrib_parsing.hpp"
 #include "adj_parsing.hpp"
 #include "rates_parsing.hpp"
-
-#ifdef XYZ
-#include "gmpfrxx/gmpfrxx.h"
-#endif
+#include "parallel.hpp"
+#include "simulation.hpp"
+#include "simulation_output.hpp"
+#include "stochastic_mapping.hpp"
+#include "expectations.hpp"
+#include "bootstrap.hpp"
+#include "root_profile.hpp"
 
 //#define DEBUG
 
+/*
+ * mean events and time in each area along the branch above every node,
+ * after those of the previous trees (tree counts from 0), and their totals
+ */
+template <typename Summary>
+void write_branch_summary(const string & filename, const Summary & summary,
+		unsigned int tree, unsigned int ntrees, const vector<string> & area_names){
+	ofstream outfile;
+	if (tree > 0)
+		outfile.open(filename.c_str(),ios::app);
+	else {
+		outfile.open(filename.c_str(),ios::out);
+		if (ntrees > 1)
+			outfile << "tree\t";
+		outfile << "node\tdispersals\textinctions";
+		for (unsigned int area = 0; area < area_names.size(); area++)
+			outfile << "\t" << area_names[area];
+		outfile << endl;
+	}
+	double dispersals = 0;
+	double extinctions = 0;
+	for (size_t s = 0; s < summary.nodes.size(); s++) {
+		Node * node = summary.nodes[s];
+		if (!node->hasParent())
+			continue;
+		if (ntrees > 1)
+			outfile << tree + 1 << "\t";
+		if (node->isInternal())
+			outfile << node->getNumber();
+		else
+			outfile << node->getName();
+		outfile << "\t" << summary.dispersals[s] << "\t" << summary.extinctions[s];
+		for (unsigned int area = 0; area < summary.dwelling[s].size(); area++)
+			outfile << "\t" << summary.dwelling[s][area];
+		outfile << endl;
+		dispersals += summary.dispersals[s];
+		extinctions += summary.extinctions[s];
+	}
+	outfile.close();
+	cout << "expected dispersals : " << dispersals << "\texpected extinctions : " << extinctions << endl;
+}
+
 int main(int argc, char* argv[]){
 
   // Raise these flags for dry-run-like checks of input interpretation.
@@ -56,22 +101,39 @@ int main(int argc, char* argv[]){
   bool check_rates_file{false};
   bool check_considered_ranges{false};
 
+  // Numeric type of the likelihood engine, possibly set from the command line
+  // (then overriding the configuration file).
+  std::optional<scalar::Type> scalar_type{};
+
   // Get a few things out of the way.
   if (argc < 2) {
     std::cerr << "No configuration file provided. Exiting." << std::endl;
     exit(1);
-  } else if (argc > 2) {
+  }
+  for (int a{2}; a < argc; ++a) {
+    const std::string_view arg{argv[a]};
+    constexpr std::string_view scalar_flag{"--scalar="};
+    if (arg.substr(0, scalar_flag.size()) == scalar_flag) {
+      const auto name{arg.substr(scalar_flag.size())};
+      scalar_type = scalar::parse(name);
+      if (!scalar_type.has_value()) {
+        std::cerr << "Unknown scalar type: '" << name << "'. ";
+        std::cerr << "Supported types are " << scalar::NAMES << "."
+                  << std::endl;
+        exit(1);
+      }
+    }
     // Hidden arguments for testing purpose only.
-    if (strcmp(argv[2], "--check-considered-ranges-detail") == 0) {
+    else if (arg == "--check-considered-ranges-detail") {
       std::cout << "Dry run to check considered ranges detail.." << std::endl;
       check_considered_ranges = true;
-    } else if (strcmp(argv[2], "--check-distribution-file-parsing") == 0) {
+    } else if (arg == "--check-distribution-file-parsing") {
       std::cout << "Dry run to check distribution file.." << std::endl;
       check_distribution_file = true;
-    } else if (strcmp(argv[2], "--check-adjacency-file-parsing") == 0) {
+    } else if (arg == "--check-adjacency-file-parsing") {
       std::cout << "Dry run to check adjacency file.." << std::endl;
       check_adjacency_file = true;
-    } else if (strcmp(argv[2], "--check-rates-file-parsing") == 0) {
+    } else if (arg == "--check-rates-file-parsing") {
       std::cout << "Dry run to check rates file.." << std::endl;
       check_rates_file = true;
     } else {
@@ -106,6 +168,8 @@ int main(int argc, char* argv[]){
   const auto& datafile{config.require_file("data", false)};
   const auto& adjacencyfile{config.seek_file("adjacency", false)};
   const auto& rate_matrix_file{config.seek_file("rate_matrix", false)};
+  // Precomputed model structure, (re)written if missing or outdated.
+  const auto& model_cache_file{config.seek_path("model_cache", false)};
 
   config.step_up();
 
@@ -114,10 +178,20 @@ int main(int argc, char* argv[]){
 
   config::AncestralState ancestral_states{config.read_ancestral_state()};
   config::ReportType report_type(config.read_report_type());
+  {
+    const auto configured{config.read_scalar_type()};
+    if (!scalar_type.has_value()) {
+      scalar_type = configured.value_or(scalar::Type::Superdouble);
+    }
+  }
   const bool classic_vicariance{
       config.seek_bool("classic_vicariance", false).value_or(false)};
   const bool rapid_anagenesis{
       config.seek_bool("rapid_anagenesis", false).value_or(false)};
+  // Expected numbers of events and time in each area along the branches,
+  // under the final rates.
+  const bool expected_events{
+      config.seek_bool("expectations", false).value_or(false)};
   std::vector<double> periods{config.read_periods()};
 
   config.step_up();
@@ -128,12 +202,14 @@ int main(int argc, char* argv[]){
   double E{0.1};
   int M{1000};
   double S{0.0001};
+  config::RatesMode R{config::RatesMode::Global};
 
   if (config.seek_table("algorithm", true).has_value()) {
     const auto& m{config.seek_integer("max_iterations", false)};
     const auto& s{config.seek_float("stopping_precision", false)};
     if (m.has_value()) { M = *m; }
     if (s.has_value()) { S = *s; }
+    R = config.read_rates_mode();
     if (config.seek_table("initial_rates", true).has_value()) {
       const auto& d{config.seek_float("dispersal", false)};
       const auto& e{config.seek_float("extinction", false)};
@@ -147,6 +223,96 @@ int main(int argc, char* argv[]){
   const double extinction{E};
   const int maxiterations{M};
   const double stoppingprecision{S};
+  const config::RatesMode rates_mode{R};
+
+  // Simulation table (optional) -----------------------------------------------
+  // Simulate ranges along the tree instead of reconstructing them,
+  // with the given rates or rates drawn anew for every replicate.
+  bool simulation{false};
+  int replicates{1};
+  unsigned long int simulation_seed{314159265};
+  std::optional<simulation::Rates> simulation_rates{};
+  config::SimulationOutput simulation_output{
+      config::SimulationOutput::PerReplicate};
+  if (config.seek_table("simulation", true).has_value()) {
+    simulation = true;
+    const auto& n{config.seek_integer("replicates", true)};
+    if (n.has_value()) {
+      replicates = *n;
+      if (replicates < 1) {
+        std::cerr << "Number of simulation replicates must be positive, not "
+                  << replicates << "." << std::endl;
+        config.source_and_exit();
+      }
+      config.step_up();
+    }
+    const auto& seed{config.seek_integer("seed", false)};
+    if (seed.has_value()) { simulation_seed = *seed; }
+    const auto& d{config.seek_float("dispersal", false)};
+    const auto& e{config.seek_float("extinction", false)};
+    if (d.has_value() != e.has_value()) {
+      std::cerr << "Simulation rates need both 'dispersal' and 'extinction'."
+                << std::endl;
+      config.source_and_exit();
+    }
+    if (d.has_value()) { simulation_rates = simulation::Rates{*d, *e}; }
+    simulation_output = config.read_simulation_output();
+    config.step_up();
+  }
+
+  // Stochastic mapping table (optional) --------------------------------------
+  // Draw histories of dispersal and extinction along the branches,
+  // given the data, under the final rates.
+  int stochastic_maps{0};
+  unsigned long int stochastic_seed{314159265};
+  if (config.seek_table("stochastic_mapping", true).has_value()) {
+    stochastic_maps = 100;
+    const auto& n{config.seek_integer("maps", true)};
+    if (n.has_value()) {
+      stochastic_maps = *n;
+      if (stochastic_maps < 1) {
+        std::cerr << "Number of stochastic maps must be positive, not "
+                  << stochastic_maps << "." << std::endl;
+        config.source_and_exit();
+      }
+      config.step_up();
+    }
+    const auto& seed{config.seek_integer("seed", false)};
+    if (seed.has_value()) { stochastic_seed = *seed; }
+    config.step_up();
+  }
+
+  // Bootstrap table (optional) -----------------------------------------------
+  // Simulate datasets under the fitted rates, and estimate them again.
+  int bootstrap_replicates{0};
+  unsigned long int bootstrap_seed{314159265};
+  if (config.seek_table("bootstrap", true).has_value()) {
+    bootstrap_replicates = 100;
+    const auto& n{config.seek_integer("replicates", true)};
+    if (n.has_value()) {
+      bootstrap_replicates = *n;
+      if (bootstrap_replicates < 1) {
+        std::cerr << "Number of bootstrap replicates must be positive, not "
+                  << bootstrap_replicates << "." << std::endl;
+        config.source_and_exit();
+      }
+      config.step_up();
+    }
+    const auto& seed{config.seek_integer("seed", false)};
+    if (seed.has_value()) { bootstrap_seed = *seed; }
+    config.step_up();
+  }
+
+  // Root profile table (optional) --------------------------------------------
+  // -ln likelihood with the root fixed at each of its ranges,
+  // under the final rates, or with the rates estimated again for each range.
+  bool profile_root{false};
+  bool profile_root_optimize{false};
+  if (config.seek_table("root_profile", true).has_value()) {
+    profile_root = true;
+    profile_root_optimize = config.seek_bool("optimize", false).value_or(false);
+    config.step_up();
+  }
 
   // Geographical parameters ---------------------------------------------------
   config.require_table("areas", true);
@@ -217,6 +383,14 @@ int main(int argc, char* argv[]){
                     fossilarea,
                     fossilage,
                     area_names);
+  // Areas of the fixed nodes come as indices, the model has ranges as 0/1.
+  for (auto& fixed : fixnodewithmrca) {
+    std::vector<int> range(area_names.size(), 0);
+    for (const int area : fixed.second) {
+      range[area] = 1;
+    }
+    fixed.second = range;
+  }
 
   // Output settings -----------------------------------------------------------
   config.require_table("output", true);
@@ -254,9 +428,9 @@ int main(int argc, char* argv[]){
 		bool NodeLHOODS = false;
 
 		bool estimate = true;
-		bool simulate = false;
-		int simNum = 1;
-		unsigned long int seed = 314159265;
+		bool simulate = simulation;
+		int simNum = replicates;
+		unsigned long int seed = simulation_seed;
 		bool ultrametric = true;	//	is false when at least one of the input trees is non-ultrametric
 		bool readTrueStates = false;
 		bool plot_output = false;
@@ -480,6 +654,7 @@ int main(int argc, char* argv[]){
 			cout << "Setting the number of threads: " << numthreads << endl;
 		}
 		rm.setup_Dmask();
+		vector<FreeDmaskCell> free_cells;
 
 		/*
 		 * if there is a ratematrixfile then it will be processed
@@ -491,7 +666,9 @@ int main(int argc, char* argv[]){
 			for(unsigned int i=0;i<dmconfig.size();i++){
 				for(unsigned int j=0;j<dmconfig[i].size();j++){
 					for(unsigned int k=0;k<dmconfig[i][j].size();k++){
-						if(dmconfig[i][j][k] != 1){
+						if(rates::is_free(dmconfig[i][j][k])){
+							cout << "?" << "\t";
+						}else if(dmconfig[i][j][k] != 1){
 							cout << dmconfig[i][j][k] << "\t";
 						}else{
 							cout << " . " << "\t";
@@ -511,7 +688,11 @@ int main(int argc, char* argv[]){
             const auto& row{period[i]};
             for (size_t j{0}; j < area_names.size(); ++j) {
               const auto& val{row[j]};
-              std::cout << val << " ";
+              if (rates::is_free(val)) {
+                std::cout << "? ";
+              } else {
+                std::cout << val << " ";
+              }
             }
             std::cout << std::endl;
           }
@@ -523,11 +704,26 @@ int main(int argc, char* argv[]){
 			for(unsigned int i=0;i<dmconfig.size();i++){
 				for(unsigned int j=0;j<dmconfig[i].size();j++){
 					for(unsigned int k=0;k<dmconfig[i][j].size();k++){
-						rm.set_Dmask_cell(i,j,k,dmconfig[i][j][k],false);
+						if(rates::is_free(dmconfig[i][j][k])){
+							FreeDmaskCell cell = {int(i),int(j),int(k)};
+							free_cells.push_back(cell);
+							rm.set_Dmask_cell(i,j,k,1,false);
+						}else
+							rm.set_Dmask_cell(i,j,k,dmconfig[i][j][k],false);
 					}
 				}
 			}
 		}
+		if (bootstrap_replicates > 0 && (rates_mode == config::RatesMode::PerPeriod || free_cells.size() > 0)) {
+			cout << "ERROR: the parametric bootstrap only estimates global dispersal and extinction rates "
+					"(neither per-period rates nor free dispersal mask cells)." << endl;
+			exit(-1);
+		}
+		if (profile_root_optimize && (rates_mode == config::RatesMode::PerPeriod || free_cells.size() > 0)) {
+			cout << "ERROR: the root profile only estimates global dispersal and extinction rates "
+					"(neither per-period rates nor free dispersal mask cells)." << endl;
+			exit(-1);
+		}
 	    /*
 		* if there is a adjacencymatrixfile then it will be processed
 		*/
@@ -568,7 +764,11 @@ int main(int argc, char* argv[]){
             const auto& row{period[i]};
             for (size_t j{0}; j < area_names.size(); ++j) {
               const auto& val{row[j]};
-              std::cout << val << " ";
+              if (rates::is_free(val)) {
+                std::cout << "? ";
+              } else {
+                std::cout << val << " ";
+              }
             }
             std::cout << std::endl;
           }
@@ -604,7 +804,10 @@ int main(int argc, char* argv[]){
 //		}else{
 //			rm.setup_dists();
 //		}
-		includedists = rm.generate_adjacent_dists(max_areas, areanamemaprev);
+		if (model_cache_file.has_value())
+			includedists = rm.generate_cached_adjacent_dists(max_areas, areanamemaprev, model_cache_file->path);
+		else
+			includedists = rm.generate_adjacent_dists(max_areas, areanamemaprev);
 		if (!simulate)
 			rm.include_tip_dists(data, includedists, areanamemaprev);
 		rm.setup_dists(includedists,true, check_considered_ranges);
@@ -635,11 +838,16 @@ int main(int argc, char* argv[]){
 		tmp.close();
 #endif
 
+		/*
+		 * one simulation engine per tree, when simulating
+		 */
+		vector<simulation::Engine> engines;
+
 		/*
 		 * start calculating on all trees
 		 */
 		for(unsigned int i=0;i<intrees.size();i++){
-			BioGeoTree bgt(intrees[i],periods);
+			BioGeoTree bgt(intrees[i],periods,*scalar_type);
 			/*
 			 * specify whether the tree is ultrametric
 			 */
@@ -734,85 +942,11 @@ int main(int argc, char* argv[]){
 			}
 
 			if (simulate) {
-				if (intrees.size() == 1) {
-					time(&likStartTime);
-
-					if (simNum > 1)
-						cout << "simulating " << simNum << " biogeotrees..." << endl;
-					else
-						cout << "simulating a single biogeotree..." << endl;
-					for (int sims = 1; sims <= simNum; sims++) {
-						if (simNum > 1)
-							cout << sims << "\t";
-						if (estimate == false) {
-							bgt.setSim_D(dispersal);
-							bgt.setSim_E(extinction);
-							bgt.prepare_simulation(seed + sims - 1, false);
-						}
-						else
-							bgt.prepare_simulation(seed + sims - 1, true);
-
-						//	output simulated states at the nodes in Newick format
-						ofstream simTree;
-						if (simNum > 1) {
-							stringstream stst;
-							stst << "SimTree." << sims << ".tre";
-							simTree.open(stst.str().c_str(),ios::out);
-						}
-						else
-							simTree.open(string("SimTree.tre").c_str(),ios::out);
-						simTree << intrees[0]->getRoot()->getNewick(true,"simstate") << ";"<< endl;
-						simTree.close();
-
-						//	output leaf distributions
-						ofstream simDistrib;
-						set<vector<int> > leafDistrib;
-						if (simNum > 1) {
-							stringstream stst;
-							stst << "SimDistrib." << sims << ".txt";
-							simDistrib.open(stst.str().c_str(),ios::out);
-						}
-						else
-							simDistrib.open(string("SimDistrib.txt").c_str(),ios::out);
-						simDistrib << intrees[0]->getExternalNodeCount() << " " << rm.get_num_areas() << endl;
-						for(size_t i = 0; i < intrees[0]->getExternalNodeCount(); i++) {
-							simDistrib << intrees[0]->getExternalNode(i)->getName() << "\t";
-							vector<int> tipDist = (*rm.get_int_dists_map())[*intrees[0]->getExternalNode(i)->getIntObject("simdistidx")];
-							for(size_t j = 0; j < tipDist.size(); j++)
-								simDistrib << tipDist[j];
-							simDistrib << endl;
-							leafDistrib.insert(tipDist);
-						}
-						simDistrib.close();
-
-						//	output interior node distributions
-						ofstream simStates;
-						if (simNum > 1) {
-							stringstream stst;
-							stst << "SimStates." << sims << ".txt";
-							simStates.open(stst.str().c_str(),ios::out);
-						}
-						else
-							simStates.open(string("SimStates.txt").c_str(),ios::out);
-						simStates << bgt.getSim_D() << endl << bgt.getSim_E() << endl;
-						for(size_t i = 0; i < intrees[0]->getInternalNodeCount(); i++) {
-							simStates << intrees[0]->getInternalNode(i)->getNumber() << "\t";
-							vector<int> nodeDist = (*rm.get_int_dists_map())[*intrees[0]->getInternalNode(i)->getIntObject("simdistidx")];
-							for(size_t j = 0; j < nodeDist.size(); j++)
-								simStates << nodeDist[j];
-							simStates << endl;
-						}
-						simStates.close();
-
-						cout << "\tleaf_dists : " << leafDistrib.size() << endl;
-					}
-					time(&likEndTime);
-					cout << "Time taken for simulation: " <<  float(likEndTime - likStartTime) << " s." << endl << endl;
-				}
-				else {
-					cout << "Simulating ancestral states for multiple trees simultaneously is currently not possible!" << endl;
-					exit(-1);
-				}
+				/*
+				 * the replicates of all the trees are simulated together,
+				 * once every tree is set up
+				 */
+				engines.emplace_back(*intrees[i],rm);
 			}
 			else {
 				/*
@@ -846,7 +980,31 @@ int main(int argc, char* argv[]){
 				Superdouble nlnlike = 0;
 				double optDisp, optExt, optLik;
 				if (estimate == true){
-					if(estimate_dispersal_mask == false){
+					if(rates_mode == config::RatesMode::PerPeriod || free_cells.size() > 0){
+						cout << "Optimizing (BFGS) -ln likelihood with " << (rates_mode == config::RatesMode::PerPeriod ? "per-period" : "global")
+							 << " rates and " << free_cells.size() << " free dispersal mask cells." << endl;
+						OptimizeBioGeo opt(&bgt,&rm,marginal,maxiterations,stoppingprecision);
+						vector<double> rates = opt.optimize_rates(rates_mode == config::RatesMode::PerPeriod, free_cells, dispersal, extinction);
+						int nrates = rates_mode == config::RatesMode::PerPeriod ? periods.size() : 1;
+						for (int p=0;p<nrates;p++){
+							if (nrates > 1)
+								cout << "period " << p << " ";
+							cout << "dis: " << rates[p] << " ext: " << rates[nrates+p] << endl;
+						}
+						for (unsigned int c=0;c<free_cells.size();c++){
+							cout << "period " << free_cells[c].period << " " << area_names[free_cells[c].from] << " -> "
+								 << area_names[free_cells[c].to] << ": " << rates[2*nrates+c] << endl;
+						}
+						optDisp = rates[0];
+						optExt = rates[nrates];
+						opt.set_rates(rates);
+						bgt.update_default_model(&rm);
+						bgt.set_store_p_matrices(true);
+						optLik = double(bgt.eval_likelihood(marginal));
+						cout << "final -ln likelihood: "<< optLik << endl;
+						bgt.set_store_p_matrices(false);
+					}
+					else if(estimate_dispersal_mask == false){
 						cout << "Optimizing (simplex) -ln likelihood." << endl;
 						OptimizeBioGeo opt(&bgt,&rm,marginal,maxiterations,stoppingprecision);
 						vector<double> disext  = opt.optimize_global_dispersal_extinction(dispersal, extinction);
@@ -945,6 +1103,53 @@ int main(int argc, char* argv[]){
 					}
 				}
 
+				/*
+				 * root profile, from the conditionals left at the root
+				 * by the final likelihood evaluation
+				 */
+				if (profile_root) {
+					time(&likStartTime);
+					vector<root_profile::Row> rows = root_profile::at_fixed_rates(bgt,rm);
+					if (profile_root_optimize) {
+						cout << "estimating the rates with the root fixed at each of " << rows.size() << " ranges..." << endl;
+						root_profile::optimize(rows,*intrees[i],rm,replica::Analysis{periods,*scalar_type,marginal,maxiterations,stoppingprecision,{dispersal,extinction}},
+								data,rm.get_nthreads());
+					}
+
+					//	one line per range, after those of the previous trees
+					ofstream outRootFile;
+					if (i > 0)
+						outRootFile.open((treefile.name+fileTag+".bgroot.txt").c_str(),ios::app);
+					else {
+						outRootFile.open((treefile.name+fileTag+".bgroot.txt").c_str(),ios::out);
+						if (intrees.size() > 1)
+							outRootFile << "tree\t";
+						outRootFile << "range\t-lnL";
+						if (profile_root_optimize)
+							outRootFile << "\tdispersal\textinction\toptimized_-lnL";
+						outRootFile << endl;
+					}
+					const root_profile::Row * best = NULL;
+					for (unsigned int r=0;r<rows.size();r++) {
+						if (intrees.size() > 1)
+							outRootFile << i + 1 << "\t";
+						outRootFile << print_area_vector((*rm.getDists())[rows[r].range],areanamemaprev) << "\t" << rows[r].likelihood;
+						if (profile_root_optimize)
+							outRootFile << "\t" << rows[r].rates.dispersal << "\t" << rows[r].rates.extinction << "\t" << rows[r].optimized;
+						outRootFile << endl;
+						double lnl = profile_root_optimize ? rows[r].optimized : rows[r].likelihood;
+						if (best == NULL || lnl < (profile_root_optimize ? best->optimized : best->likelihood))
+							best = &rows[r];
+					}
+					outRootFile.close();
+
+					if (best != NULL)
+						cout << "most likely root range : " << print_area_vector((*rm.getDists())[best->range],areanamemaprev)
+							 << " (-lnL " << (profile_root_optimize ? best->optimized : best->likelihood) << ")" << endl;
+					time(&likEndTime);
+					cout << "Time taken for the root profile: " <<  float(likEndTime - likStartTime) << " s." << endl << endl;
+				}
+
 				/*
 				 * testing BAYESIAN
 				 */
@@ -961,7 +1166,15 @@ int main(int argc, char* argv[]){
 				if(ancestral_states.some()){
 					bgt.set_use_stored_matrices(true);
 
-					bgt.prepare_ancstate_reverse();
+					if(ancestral_states.all)
+						bgt.prepare_ancstate_reverse();
+					else{
+						//only down to the requested nodes
+						vector<Node *> ancnodes;
+						for(unsigned int j=0;j<ancestral_states.states.size();j++)
+							ancnodes.push_back(mrcanodeint[ancestral_states.states[j]]);
+						bgt.prepare_ancstate_reverse(ancnodes);
+					}
 					Superdouble totlike = 0; // calculate_vector_double_sum(rast) , should be the same for every node
 
 					if(ancestral_states.all){
@@ -994,14 +1207,34 @@ int main(int argc, char* argv[]){
 							outTreeFile.close();
 						}
 
-						for(int j=0;j<intrees[i]->getInternalNodeCount();j++){
+						/*
+						 * nodes are reconstructed in parallel, a block at a time
+						 * to bound the memory of the splits, then reported in node order
+						 */
+						const int nnodes = intrees[i]->getInternalNodeCount();
+						const int block = 256;
+						vector<Node *> blocknodes;
+						vector<vector<Superdouble> > blocksplits(block);
+						vector<vector<Superdouble> > blockstates(block);
+						for(int j=0;j<nnodes;j++){
+							if (j % block == 0){
+								blocknodes.clear();
+								for(int k=j;k<min(j+block,nnodes);k++)
+									blocknodes.push_back(intrees[i]->getInternalNode(k));
+								parallel::for_each_index(blocknodes.size(), rm.get_nthreads(), [&](size_t k){
+									if (report_type == config::ReportType::Splits)
+										blocksplits[k] = bgt.calculate_ancsplit_reverse(*blocknodes[k],marginal);
+									else
+										blockstates[k] = bgt.calculate_ancstate_reverse(*blocknodes[k],marginal);
+								});
+							}
 
               // Old paired ifs replaced by switch when introducing ReportType.
               switch (report_type) {
                 case config::ReportType::Splits: {
 
 								cout << "Ancestral splits for:\t" << intrees[i]->getInternalNode(j)->getNumber() <<endl;
-								map<vector<int>,vector<AncSplit> > ras = bgt.calculate_ancsplit_reverse(*intrees[i]->getInternalNode(j),marginal);
+								vector<Superdouble> & ras = blocksplits[j % block];
 								//bgt.ancstate_calculation_all_dists(*intrees[i]->getNode(j),marginal);
 								tt.summarizeSplits(intrees[i]->getInternalNode(j),ras,areanamemaprev,&rm);
 								cout << endl;
@@ -1011,7 +1244,7 @@ int main(int argc, char* argv[]){
                 case config::ReportType::States: {
 
 								cout << "Ancestral states for:\t" << intrees[i]->getInternalNode(j)->getNumber() <<endl;
-								vector<Superdouble> rast = bgt.calculate_ancstate_reverse(*intrees[i]->getInternalNode(j),marginal);
+								vector<Superdouble> & rast = blockstates[j % block];
 								totlike = calculate_vector_Superdouble_sum(rast);
 
 								ofstream NodeLHOODFile;
@@ -1114,7 +1347,7 @@ int main(int argc, char* argv[]){
                 case config::ReportType::Splits: {
 
 								cout << "Ancestral splits for: " << ancstates[j] <<endl;
-								map<vector<int>,vector<AncSplit> > ras = bgt.calculate_ancsplit_reverse(*mrcanodeint[ancstates[j]],marginal);
+								vector<Superdouble> ras = bgt.calculate_ancsplit_reverse(*mrcanodeint[ancstates[j]],marginal);
 								tt.summarizeSplits(mrcanodeint[ancstates[j]],ras,areanamemaprev,&rm);
                   break;
                 }
@@ -1279,10 +1512,107 @@ int main(int argc, char* argv[]){
 	*/
 
 				}
+
+				/*
+				 * stochastic mapping, from the conditionals and the P matrices
+				 * stored by the final likelihood evaluation
+				 */
+				if (stochastic_maps > 0) {
+					time(&likStartTime);
+					cout << "drawing " << stochastic_maps << " stochastic maps..." << endl;
+					stochastic_mapping::Mapper mapper(*intrees[i],bgt,rm);
+					stochastic_mapping::Summary summary = mapper.run(stochastic_maps,stochastic_seed,rm.get_nthreads());
+
+					write_branch_summary(treefile.name+fileTag+".bgstochmap.txt",summary,i,intrees.size(),area_names);
+					time(&likEndTime);
+					cout << "Time taken for stochastic mapping: " <<  float(likEndTime - likStartTime) << " s." << endl << endl;
+				}
+
+				/*
+				 * the same expectations, without sampling
+				 */
+				if (expected_events) {
+					time(&likStartTime);
+					cout << "calculating expected events..." << endl;
+					expectations::Summary summary = expectations::expected(*intrees[i],bgt,rm,rm.get_nthreads());
+					write_branch_summary(treefile.name+fileTag+".bgexpect.txt",summary,i,intrees.size(),area_names);
+					time(&likEndTime);
+					cout << "Time taken for expectations: " <<  float(likEndTime - likStartTime) << " s." << endl << endl;
+				}
+
+				/*
+				 * parametric bootstrap, from the fitted rates
+				 */
+				if (bootstrap_replicates > 0) {
+					time(&likStartTime);
+					cout << "analysing " << bootstrap_replicates << " bootstrap replicates..." << endl;
+					simulation::Rates fitted = estimate ? simulation::Rates{optDisp, optExt} : simulation::Rates{dispersal, extinction};
+					bootstrap::Bootstrap boot(*intrees[i],rm,replica::Analysis{periods,*scalar_type,marginal,maxiterations,stoppingprecision,{dispersal,extinction}});
+
+					//	one line per replicate, after those of the previous trees
+					ofstream outBootstrapFile;
+					if (i > 0)
+						outBootstrapFile.open((treefile.name+fileTag+".bgbootstrap.txt").c_str(),ios::app);
+					else {
+						outBootstrapFile.open((treefile.name+fileTag+".bgbootstrap.txt").c_str(),ios::out);
+						if (intrees.size() > 1)
+							outBootstrapFile << "tree\t";
+						outBootstrapFile << "replicate\tseed\tdispersal\textinction\t-lnL\tcorrect_states" << endl;
+					}
+					bootstrap::Summary summary = boot.run(bootstrap_replicates,bootstrap_seed,fitted,rm.get_nthreads(),
+							[&](const bootstrap::Estimate & estimate){
+						if (intrees.size() > 1)
+							outBootstrapFile << i + 1 << "\t";
+						outBootstrapFile << estimate.number << "\t" << estimate.seed;
+						if (estimate.analysed)
+							outBootstrapFile << "\t" << estimate.rates.dispersal << "\t" << estimate.rates.extinction
+								<< "\t" << estimate.likelihood << "\t" << estimate.correct << endl;
+						else
+							outBootstrapFile << "\tNA\tNA\tNA\tNA" << endl;
+					});
+					outBootstrapFile.close();
+
+					cout << "replicates analysed : " << summary.analysed << " of " << bootstrap_replicates << endl
+						 << "dispersal : " << summary.mean.dispersal << " (sd " << summary.sd.dispersal
+						 << ", bias " << summary.mean.dispersal - fitted.dispersal << ")" << endl
+						 << "extinction : " << summary.mean.extinction << " (sd " << summary.sd.extinction
+						 << ", bias " << summary.mean.extinction - fitted.extinction << ")" << endl
+						 << "fraction of correctly estimated states : " << summary.correct << endl;
+					time(&likEndTime);
+					cout << "Time taken for the bootstrap: " <<  float(likEndTime - likStartTime) << " s." << endl << endl;
+				}
 				//need to delete the biogeostuff
 			}
 		}
 
+		if (simulate) {
+			time(&likStartTime);
+
+			if (intrees.size() > 1)
+				cout << "simulating " << simNum << " biogeotree(s) on each of " << intrees.size() << " trees..." << endl;
+			else if (simNum > 1)
+				cout << "simulating " << simNum << " biogeotrees..." << endl;
+			else
+				cout << "simulating a single biogeotree..." << endl;
+			if (simulation_rates.has_value() && simulation_rates->dispersal < simulation_rates->extinction)
+				cout << "Note that manually setting the rate of geographic dispersal to be less than that of extinction"
+						"\nwill lead to highly trivial biogeographic histories. Continuing anyway..." << endl;
+			/*
+			 * (tree, replicate) pairs are simulated in parallel, a block at a time
+			 * to bound their memory, and written out by another thread
+			 * while the next block is simulated
+			 */
+			{
+				simulation::Writer writer(engines,intrees,rm,simNum,simulation_output);
+				const size_t pairs = engines.size() * simNum;
+				const size_t block = 256;
+				for (size_t p = 0; p < pairs; p += block)
+					writer.push(simulation::run(engines,simNum,p,min(block,pairs - p),seed,simulation_rates,rm.get_nthreads()));
+			}
+			time(&likEndTime);
+			cout << "Time taken for simulation: " <<  float(likEndTime - likStartTime) << " s." << endl << endl;
+		}
+
 		for(unsigned int i=0;i<intrees.size();i++){
 			delete intrees[i];
 		}
@@ -0,0 +1,68 @@
+#include "matrix.hpp"
+
+#include <algorithm>
+#include <new>
+
+namespace matrix {
+
+namespace {
+
+// Round the row length up to a whole number of aligned blocks.
+int padded(const int cols) {
+  constexpr int per_block{ALIGNMENT / sizeof(double)};
+  return (cols + per_block - 1) / per_block * per_block;
+}
+
+double* allocate(const size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  void* block{std::aligned_alloc(ALIGNMENT, size * sizeof(double))};
+  if (block == nullptr) {
+    throw std::bad_alloc();
+  }
+  return static_cast<double*>(block);
+}
+
+} // namespace
+
+Matrix::Matrix(const int rows, const int cols, const double value)
+    : n_rows{rows}, n_cols{cols}, row_stride{padded(cols)},
+      block{allocate(static_cast<size_t>(rows) * padded(cols))} {
+  for (int i{0}; i < n_rows; ++i) {
+    double* row{(*this)[i]};
+    std::fill(row, row + n_cols, value);
+    std::fill(row + n_cols, row + row_stride, 0);
+  }
+}
+
+Matrix::Matrix(const Matrix& other)
+    : n_rows{other.n_rows}, n_cols{other.n_cols},
+      row_stride{other.row_stride},
+      block{allocate(static_cast<size_t>(other.n_rows) * other.row_stride)} {
+  std::copy(other.data(), other.data() + size_t(n_rows) * row_stride, data());
+}
+
+Matrix& Matrix::operator=(const Matrix& other) {
+  if (this != &other) {
+    if (n_rows != other.n_rows || row_stride != other.row_stride) {
+      block.reset(allocate(static_cast<size_t>(other.n_rows) *
+                           other.row_stride));
+    }
+    n_rows = other.n_rows;
+    n_cols = other.n_cols;
+    row_stride = other.row_stride;
+    std::copy(other.data(), other.data() + size_t(n_rows) * row_stride,
+              data());
+  }
+  return *this;
+}
+
+bool operator==(const Matrix& a, const Matrix& b) {
+  // Padding is always zero, so whole blocks compare.
+  return a.rows() == b.rows() && a.cols() == b.cols() &&
+         std::equal(a.data(), a.data() + size_t(a.rows()) * a.stride(),
+                    b.data());
+}
+
+} // namespace matrix
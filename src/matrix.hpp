@@ -0,0 +1,75 @@
+#pragma once
+
+// Dense row-major matrix of doubles, in a single 64-byte aligned block.
+// Rows are padded to a multiple of 8 doubles so that each one starts
+// on a cache line; the padded row length is the leading dimension
+// to hand to BLAS (which then sees the transpose, being column-major).
+//
+// m[i] points to row i, so entries read m[i][j] as with nested vectors.
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+
+namespace matrix {
+
+constexpr size_t ALIGNMENT{64};
+
+class Matrix {
+  struct Free {
+    void operator()(double* block) const { std::free(block); }
+  };
+
+  int n_rows{0};
+  int n_cols{0};
+  int row_stride{0};
+  std::unique_ptr<double[], Free> block;
+
+public:
+  Matrix() = default;
+  Matrix(int rows, int cols, double value = 0);
+  Matrix(const Matrix& other);
+  Matrix& operator=(const Matrix& other);
+  Matrix(Matrix&&) noexcept = default;
+  Matrix& operator=(Matrix&&) noexcept = default;
+
+  int rows() const { return n_rows; }
+  int cols() const { return n_cols; }
+  int stride() const { return row_stride; }
+  double* data() { return block.get(); }
+  const double* data() const { return block.get(); }
+  double* operator[](const int i) {
+    return block.get() + static_cast<size_t>(i) * row_stride;
+  }
+  const double* operator[](const int i) const {
+    return block.get() + static_cast<size_t>(i) * row_stride;
+  }
+};
+
+// Same shape and entries.
+bool operator==(const Matrix& a, const Matrix& b);
+
+// Read-only window onto a matrix, to pass it around without copying.
+// Valid as long as the matrix is neither destroyed nor reassigned.
+class View {
+  const double* first{nullptr};
+  int n_rows{0};
+  int n_cols{0};
+  int row_stride{0};
+
+public:
+  View() = default;
+  View(const Matrix& m)
+      : first{m.data()}, n_rows{m.rows()}, n_cols{m.cols()},
+        row_stride{m.stride()} {}
+
+  int rows() const { return n_rows; }
+  int cols() const { return n_cols; }
+  int stride() const { return row_stride; }
+  const double* data() const { return first; }
+  const double* operator[](const int i) const {
+    return first + static_cast<size_t>(i) * row_stride;
+  }
+};
+
+} // namespace matrix
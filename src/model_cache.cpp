@@ -0,0 +1,391 @@
+#include "model_cache.hpp"
+
+#include "RateModel.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace model_cache {
+
+// File layout (native byte order, all counts as uint64):
+//
+//   magic, version, endianness marker, key
+//   n_areas, n_periods, n_ranges
+//   ranges:   n_ranges × n_areas bytes (0/1)
+//   default adjacency flag (1 byte)
+//   for every period:
+//     included ranges (uint32 indices into ranges)
+//     excluded ranges (same, only without default adjacency)
+//   for every range, for every period:
+//     splits (uint32 left/right index pairs)
+//   for every period:
+//     number of included ranges covered by the Q pattern
+//     Q cells (int32 row, col, first term, last term)
+//     Q terms (int32 src, dest)
+constexpr char MAGIC[8]{'D', 'E', 'C', 'X', 'M', 'C', '\0', '\0'};
+constexpr uint32_t ENDIANNESS{0x01020304};
+
+// FNV-1a, stable across runs and platforms.
+class Hasher {
+  Key hash{14695981039346656037ull};
+
+public:
+  void bytes(const void* data, const size_t size) {
+    const auto* b{static_cast<const unsigned char*>(data)};
+    for (size_t i{0}; i < size; ++i) {
+      hash ^= b[i];
+      hash *= 1099511628211ull;
+    }
+  }
+  template <typename T> void value(const T& v) { bytes(&v, sizeof(T)); }
+  Key get() const { return hash; }
+};
+
+Key key(const RateModel& rm) {
+  Hasher h;
+  h.value(static_cast<uint64_t>(rm.nareas));
+  h.value(static_cast<uint64_t>(rm.maxareas));
+  h.value(static_cast<uint64_t>(rm.periods.size()));
+  h.value(rm.globalext);
+  h.value(rm.classic_vicariance);
+  h.value(rm.rapid_anagenesis);
+  for (const auto& [_, name] : rm.areanamemaprev) {
+    h.value(static_cast<uint64_t>(name.size()));
+    h.bytes(name.data(), name.size());
+  }
+  h.value(rm.default_adjacency);
+  if (!rm.default_adjacency) {
+    for (const auto& period : rm.adjMat) {
+      for (const auto& row : period) {
+        for (const bool adjacent : row) {
+          h.value(adjacent);
+        }
+      }
+    }
+  }
+  return h.get();
+}
+
+//------------------------------------------------------------------------------
+// Writing.
+
+class Writer {
+  std::ofstream file;
+
+public:
+  Writer(const std::string& path) : file(path, std::ios::binary) {}
+  bool good() const { return file.good(); }
+  void bytes(const void* data, const size_t size) {
+    file.write(static_cast<const char*>(data), size);
+  }
+  template <typename T> void value(const T& v) { bytes(&v, sizeof(T)); }
+  template <typename T> void array(const std::vector<T>& v) {
+    value(static_cast<uint64_t>(v.size()));
+    bytes(v.data(), v.size() * sizeof(T));
+  }
+};
+
+void save(const std::string& path,
+          const RateModel& rm,
+          const std::vector<std::vector<int>>& rangemap) {
+
+  std::map<std::vector<int>, uint32_t> index;
+  for (size_t i{0}; i < rangemap.size(); ++i) {
+    index[rangemap[i]] = i;
+  }
+  auto indices{[&](const std::vector<std::vector<int>>& ranges) {
+    std::vector<uint32_t> result;
+    result.reserve(ranges.size());
+    for (const auto& range : ranges) {
+      result.push_back(index.at(range));
+    }
+    return result;
+  }};
+
+  // Write aside first so concurrent runs never read a partial file.
+  const std::string tmp{path + "." + std::to_string(getpid()) + ".tmp"};
+  {
+    Writer w{tmp};
+    const size_t n_periods{rm.periods.size()};
+    w.bytes(MAGIC, sizeof(MAGIC));
+    w.value(VERSION);
+    w.value(ENDIANNESS);
+    w.value(key(rm));
+    w.value(static_cast<uint64_t>(rm.nareas));
+    w.value(static_cast<uint64_t>(n_periods));
+    w.value(static_cast<uint64_t>(rangemap.size()));
+    std::vector<uint8_t> areas(rm.nareas);
+    for (const auto& range : rangemap) {
+      for (int a{0}; a < rm.nareas; ++a) {
+        areas[a] = range[a];
+      }
+      w.bytes(areas.data(), areas.size());
+    }
+
+    w.value(static_cast<uint8_t>(rm.default_adjacency));
+    for (size_t p{0}; p < n_periods; ++p) {
+      w.array(indices(rm.incldists_per_period[p]));
+      if (!rm.default_adjacency) {
+        w.array(indices(rm.excldists_per_period[p]));
+      }
+    }
+
+    std::vector<uint32_t> pairs;
+    for (const auto& range : rangemap) {
+      const auto& per_period{rm.iter_dists_per_period.at(range)};
+      for (size_t p{0}; p < n_periods; ++p) {
+        const auto& left{per_period.at(p)[0]};
+        const auto& right{per_period.at(p)[1]};
+        pairs.clear();
+        for (size_t s{0}; s < left.size(); ++s) {
+          pairs.push_back(index.at(left[s]));
+          pairs.push_back(index.at(right[s]));
+        }
+        w.value(static_cast<uint64_t>(left.size()));
+        w.bytes(pairs.data(), pairs.size() * sizeof(uint32_t));
+      }
+    }
+
+    for (size_t p{0}; p < n_periods; ++p) {
+      w.value(static_cast<uint64_t>(rm.Q_pattern_extent[p]));
+      w.array(rm.Q_cells[p]);
+      w.array(rm.Q_terms[p]);
+    }
+
+    if (!w.good()) {
+      std::cerr << "Warning: could not write model cache file "
+                << "'" << tmp << "'." << std::endl;
+      std::remove(tmp.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    std::cerr << "Warning: could not write model cache file "
+              << "'" << path << "'." << std::endl;
+    std::remove(tmp.c_str());
+    return;
+  }
+  std::cout << "Model structure written to cache file '" << path << "'."
+            << std::endl;
+}
+
+//------------------------------------------------------------------------------
+// Reading.
+
+// Scroll mapped memory, failing softly on truncation.
+class Cursor {
+  const char* current;
+  const char* end;
+
+public:
+  Cursor(const char* begin, const size_t size) :
+      current(begin), end(begin + size) {}
+  bool bytes(void* data, const size_t size) {
+    if (static_cast<size_t>(end - current) < size) {
+      return false;
+    }
+    std::memcpy(data, current, size);
+    current += size;
+    return true;
+  }
+  template <typename T> bool value(T& v) { return bytes(&v, sizeof(T)); }
+  template <typename T> bool array(std::vector<T>& v) {
+    uint64_t size;
+    if (!value(size) || size > static_cast<size_t>(end - current) / sizeof(T)) {
+      return false;
+    }
+    v.resize(size);
+    return bytes(v.data(), size * sizeof(T));
+  }
+  bool done() const { return current == end; }
+};
+
+// Unmap on scope exit.
+struct Mapping {
+  void* data{MAP_FAILED};
+  size_t size{0};
+  ~Mapping() {
+    if (data != MAP_FAILED) {
+      munmap(data, size);
+    }
+  }
+};
+
+bool load(const std::string& path,
+          RateModel& rm,
+          std::vector<std::vector<int>>& rangemap) {
+
+  Mapping mapping;
+  {
+    const int fd{open(path.c_str(), O_RDONLY)};
+    if (fd < 0) {
+      std::cout << "\nNo model cache file found at '" << path << "', "
+                << "computing model structure.." << std::endl;
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      mapping.size = st.st_size;
+      mapping.data = mmap(nullptr, mapping.size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+  }
+  auto reject{[&](const std::string& reason) {
+    std::cout << "\nModel cache file '" << path << "' " << reason << ", "
+              << "recomputing model structure.." << std::endl;
+    return false;
+  }};
+  if (mapping.data == MAP_FAILED) {
+    return reject("could not be read");
+  }
+  Cursor c{static_cast<const char*>(mapping.data), mapping.size};
+
+  char magic[sizeof(MAGIC)];
+  uint32_t version, endianness;
+  Key file_key;
+  if (!c.bytes(magic, sizeof(magic)) ||
+      std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+    return reject("is not a DECX model cache");
+  }
+  if (!c.value(version) || version != VERSION || !c.value(endianness) ||
+      endianness != ENDIANNESS) {
+    return reject("was written by another DECX version or platform");
+  }
+  if (!c.value(file_key) || file_key != key(rm)) {
+    return reject("corresponds to another geography");
+  }
+
+  const std::string truncated{"is truncated or corrupted"};
+  uint64_t n_areas, n_periods, n_ranges;
+  if (!c.value(n_areas) || !c.value(n_periods) || !c.value(n_ranges) ||
+      n_areas != static_cast<uint64_t>(rm.nareas) ||
+      n_periods != rm.periods.size()) {
+    return reject(truncated);
+  }
+
+  std::vector<std::vector<int>> ranges(n_ranges, std::vector<int>(n_areas));
+  std::vector<uint8_t> areas(n_areas);
+  for (auto& range : ranges) {
+    if (!c.bytes(areas.data(), n_areas)) {
+      return reject(truncated);
+    }
+    for (size_t a{0}; a < n_areas; ++a) {
+      range[a] = areas[a];
+    }
+  }
+  // Check indices into ranges while reading them.
+  auto resolve{[&](const std::vector<uint32_t>& indices,
+                   std::vector<std::vector<int>>& result) {
+    result.clear();
+    result.reserve(indices.size());
+    for (const auto i : indices) {
+      if (i >= n_ranges) {
+        return false;
+      }
+      result.push_back(ranges[i]);
+    }
+    return true;
+  }};
+
+  uint8_t default_adjacency;
+  if (!c.value(default_adjacency) ||
+      default_adjacency != static_cast<uint8_t>(rm.default_adjacency)) {
+    return reject(truncated);
+  }
+  std::vector<std::vector<std::vector<int>>> incl(n_periods), excl;
+  std::vector<std::vector<int>> incl_int(n_periods);
+  std::vector<uint32_t> indices;
+  for (size_t p{0}; p < n_periods; ++p) {
+    if (!c.array(indices) || !resolve(indices, incl[p])) {
+      return reject(truncated);
+    }
+    incl_int[p].assign(indices.begin(), indices.end());
+    if (!default_adjacency) {
+      excl.emplace_back();
+      if (!c.array(indices) || !resolve(indices, excl.back())) {
+        return reject(truncated);
+      }
+    }
+  }
+
+  std::map<std::vector<int>, std::map<int, std::vector<std::vector<std::vector<int>>>>>
+      splits;
+  for (const auto& range : ranges) {
+    auto& per_period{splits[range]};
+    for (size_t p{0}; p < n_periods; ++p) {
+      uint64_t n_splits;
+      if (!c.value(n_splits) || n_splits > mapping.size) {
+        return reject(truncated);
+      }
+      indices.resize(2 * n_splits);
+      if (!c.bytes(indices.data(), indices.size() * sizeof(uint32_t))) {
+        return reject(truncated);
+      }
+      std::vector<std::vector<int>> left, right;
+      left.reserve(n_splits);
+      right.reserve(n_splits);
+      for (size_t s{0}; s < n_splits; ++s) {
+        if (indices[2 * s] >= n_ranges || indices[2 * s + 1] >= n_ranges) {
+          return reject(truncated);
+        }
+        left.push_back(ranges[indices[2 * s]]);
+        right.push_back(ranges[indices[2 * s + 1]]);
+      }
+      per_period[p].push_back(std::move(left));
+      per_period[p].push_back(std::move(right));
+    }
+  }
+
+  auto within{[](const int i, const uint64_t bound) {
+    return i >= 0 && static_cast<uint64_t>(i) < bound;
+  }};
+  std::vector<size_t> extent(n_periods);
+  std::vector<std::vector<RateModel::Qcell>> cells(n_periods);
+  std::vector<std::vector<RateModel::Qterm>> terms(n_periods);
+  for (size_t p{0}; p < n_periods; ++p) {
+    uint64_t e;
+    if (!c.value(e) || e != incl[p].size() || !c.array(cells[p]) ||
+        !c.array(terms[p])) {
+      return reject(truncated);
+    }
+    extent[p] = e;
+    for (const auto& cell : cells[p]) {
+      if (!within(cell.row, e) || !within(cell.col, e) ||
+          !within(cell.first, cell.last + 1) ||
+          !within(cell.last, terms[p].size() + 1)) {
+        return reject(truncated);
+      }
+    }
+    for (const auto& term : terms[p]) {
+      if ((term.src >= 0 && !within(term.src, n_areas)) ||
+          !within(term.dest, n_areas)) {
+        return reject(truncated);
+      }
+    }
+  }
+  if (!c.done()) {
+    return reject(truncated);
+  }
+
+  // All good: hand over to the model.
+  rm.incldists_per_period = std::move(incl);
+  rm.incldistsint_per_period = std::move(incl_int);
+  rm.excldists_per_period = std::move(excl);
+  rm.iter_dists_per_period = std::move(splits);
+  rm.Q_pattern_extent = std::move(extent);
+  rm.Q_cells = std::move(cells);
+  rm.Q_terms = std::move(terms);
+  rangemap = std::move(ranges);
+  std::cout << "\nModel structure read from cache file '" << path << "'."
+            << std::endl;
+  return true;
+}
+
+} // namespace model_cache
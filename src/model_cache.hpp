@@ -0,0 +1,50 @@
+#pragma once
+
+// Persist the deterministic part of the model structure to disk
+// so it needs not be recomputed for every run over the same geography.
+//
+// For a given list of areas, adjacency matrices, maximum range size,
+// 'classic_vicariance' and 'rapid_anagenesis' setting,
+// the following are always the same, regardless of the tree or the data:
+//
+//  - ranges considered in every period (and the excluded ones)
+//  - cladogenetic splits of every range in every period
+//  - sparsity pattern of Q: which cells are filled with which D/E terms.
+//
+// They are collected into a versioned binary file
+// keyed by a hash of these inputs,
+// and memory-mapped on subsequent runs instead of being recomputed.
+// Data-specific adjustments (tip ranges conflicting with adjacency
+// or bigger than the maximum range size)
+// are patched onto the cached structure afterwards.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class RateModel;
+
+namespace model_cache {
+
+// Bump whenever the file layout or the cached computations change.
+constexpr uint32_t VERSION{1};
+
+using Key = uint64_t;
+
+// Hash every input the structure depends upon.
+Key key(const RateModel& rm);
+
+// Restore structure from the file into the model.
+// Return false if the file is missing, unreadable,
+// or corresponds to another version or another geography.
+bool load(const std::string& path,
+          RateModel& rm,
+          std::vector<std::vector<int>>& rangemap);
+
+// Write model structure to file (atomically replaced).
+// Failing to write only issues a warning.
+void save(const std::string& path,
+          const RateModel& rm,
+          const std::vector<std::vector<int>>& rangemap);
+
+} // namespace model_cache
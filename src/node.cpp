@@ -23,17 +23,17 @@ using namespace std;
 
 Node::Node():BL(0.0),height(0.0),number(0), name(""),
 		parent(NULL),children(vector<Node *> ()),assoc(map<string,NodeObject *>()),
-		assocDV(map<string,vector<Superdouble> >()),comment(""),period(0){
+		comment(""),period(0){
 		}
 
 Node::Node(Node * inparent):BL(0.0),height(0.0),number(0), name(""),
 		parent(inparent),children(vector<Node *> ()),assoc(map<string,NodeObject *>()),
-		assocDV(map<string,vector<Superdouble> >()),comment(""),period(0){
+		comment(""),period(0){
 		}
 
 Node::Node(double bl,int innumber,string inname, Node * inparent) :BL(bl),height(0.0),
 		number(innumber), name(inname),parent(inparent),children(vector<Node *> ()),
-		assoc(map<string,NodeObject *>()),assocDV(map<string,vector<Superdouble> >()),comment(""),period(0){
+		assoc(map<string,NodeObject *>()),comment(""),period(0){
 		}
 
 vector<Node*> Node::getChildren(){
@@ -276,15 +276,17 @@ void Node::assocObject(string name,NodeObject & obj){
 	assoc[name] = obj.clone();
 }
 
-void Node::assocDoubleVector(string name, vector<Superdouble> & obj){
-	if (assocDV.count(name) > 0 ){
-		assocDV.erase(name);
+template <typename Scalar>
+void Node::assocDoubleVector(string name, vector<Scalar> & obj){
+	map<string, vector<Scalar> > & dv = get<map<string, vector<Scalar> > >(assocDV);
+	if (dv.count(name) > 0 ){
+		dv.erase(name);
 	}
-	vector<Superdouble> tvec (obj.size());
+	vector<Scalar> tvec (obj.size());
 	for (unsigned int i=0;i<obj.size();i++){
 		tvec[i] = obj[i];
 	}
-	assocDV[name] = tvec;
+	dv[name] = tvec;
 }
 
 void Node::setIntObject(string name, int & obj)
@@ -295,8 +297,9 @@ void Node::setIntObject(string name, int & obj)
 	intObject[name] = obj;
 }
 
-vector<Superdouble> * Node::getDoubleVector(string name){
-	return &assocDV[name];
+template <typename Scalar>
+vector<Scalar> * Node::getDoubleVector(string name){
+	return &get<map<string, vector<Scalar> > >(assocDV)[name];
 }
 
 int * Node::getIntObject(string name)
@@ -305,9 +308,9 @@ int * Node::getIntObject(string name)
 }
 
 void Node::deleteDoubleVector(string name){
-	if (assocDV.count(name) > 0 ){
-		assocDV.erase(name);
-	}
+	get<0>(assocDV).erase(name);
+	get<1>(assocDV).erase(name);
+	get<2>(assocDV).erase(name);
 }
 
 
@@ -352,3 +355,12 @@ NodeObject  * Node::getObject(string name){
 	return assoc[name];
 }
 
+/*
+ * the vectors come in each of the numeric types of the likelihood engine
+ */
+template void Node::assocDoubleVector<Superdouble>(string, vector<Superdouble> &);
+template void Node::assocDoubleVector<long double>(string, vector<long double> &);
+template void Node::assocDoubleVector<double>(string, vector<double> &);
+template vector<Superdouble> * Node::getDoubleVector<Superdouble>(string);
+template vector<long double> * Node::getDoubleVector<long double>(string);
+template vector<double> * Node::getDoubleVector<double>(string);
@@ -18,6 +18,7 @@ using namespace std;
 #include "vector_node_object.h"
 #include "BranchSegment.h"
 #include "superdouble.h"
+#include "scalar.hpp"
 
 class Node{
 private:
@@ -29,7 +30,9 @@ private:
 	Node * parent;
 	vector<Node *> children;
 	map<string,NodeObject *> assoc;
-	map<string, vector<Superdouble> > assocDV;
+	template <typename Scalar>
+	using DoubleVectors = map<string, vector<Scalar> >;
+	scalar::PerType<DoubleVectors> assocDV;
 	map<string,int> intObject;
 	string comment;
 	vector<BranchSegment> * segs;
@@ -69,9 +72,11 @@ public:
 	Node * getParent();
 	int getChildCount();
 	void assocObject(string name,NodeObject & obj);
-	void assocDoubleVector(string name, vector<Superdouble> & obj);
+	template <typename Scalar>
+	void assocDoubleVector(string name, vector<Scalar> & obj);
 	void setIntObject(string name, int & obj);
-	vector<Superdouble> * getDoubleVector(string name);
+	template <typename Scalar>
+	vector<Scalar> * getDoubleVector(string name);
 	int * getIntObject(string name);
 	void deleteDoubleVector(string name);
 	void initSegVector();
@@ -0,0 +1,200 @@
+#include "pade.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+extern "C" {
+void dgemm_(const char* transa, const char* transb, const int* m,
+            const int* n, const int* k, const double* alpha, const double* a,
+            const int* lda, const double* b, const int* ldb,
+            const double* beta, double* c, const int* ldc);
+void dgesv_(const int* n, const int* nrhs, double* a, const int* lda,
+            int* ipiv, double* b, const int* ldb, int* info);
+}
+
+namespace pade {
+
+namespace {
+
+// Greatest 1-norm for which a Taylor polynomial of degree 1, 2, 3 or 4
+// truncates below the unit roundoff: ||A||^(k+1) / (k+1)! <= 2^-53.
+constexpr double TAYLOR_THETA[]{1.5e-8, 8.7e-6, 2.2e-4, 1.6e-3};
+
+// Greatest 1-norm for which the Padé approximant of degree 3, 5, 7, 9, 13
+// has a backward error below the unit roundoff (Higham 2005, table 2.3).
+constexpr int PADE_DEGREES[]{3, 5, 7, 9, 13};
+constexpr double PADE_THETA[]{1.495585217958292e-2, 2.539398330063230e-1,
+                              9.504178996162932e-1, 2.097847961257068e+0,
+                              5.371920351148152e+0};
+
+// Coefficients b_0 .. b_m of the numerator, for each degree.
+constexpr double B3[]{120, 60, 12, 1};
+constexpr double B5[]{30240, 15120, 3360, 420, 30, 1};
+constexpr double B7[]{17297280, 8648640, 1995840, 277200, 25200, 1512, 56, 1};
+constexpr double B9[]{17643225600., 8821612800., 2075673600., 302702400.,
+                      30270240,     2162160,     110880,      3960,
+                      90,           1};
+constexpr double B13[]{64764752532480000., 32382376266240000.,
+                       7771770303897600.,  1187353796428800.,
+                       129060195264000.,   10559470521600.,
+                       670442572800.,      33522128640.,
+                       1323241920.,        40840800.,
+                       960960.,            16380.,
+                       182.,               1.};
+
+// c = alpha·a·b + beta·c
+void product(const int m, const double alpha, const double* a,
+             const double* b, double* c, const double beta = 0) {
+  const char no{'n'};
+  dgemm_(&no, &no, &m, &m, &m, &alpha, a, &m, b, &m, &beta, c, &m);
+}
+
+void identity(const int m, double* a, const double diagonal = 1) {
+  std::fill(a, a + m * m, 0);
+  for (int i{0}; i < m; ++i) {
+    a[i * (m + 1)] = diagonal;
+  }
+}
+
+} // namespace
+
+double* Workspace::argument(const int m) {
+  order = m;
+  const size_t mm{static_cast<size_t>(m) * m};
+  if (blocks.size() < 7 * mm) {
+    blocks.resize(7 * mm);
+    pivots.resize(m);
+  }
+  return blocks.data();
+}
+
+const double* exp(Workspace& ws) {
+  const int m{ws.order};
+  const int mm{m * m};
+  double* a{ws.blocks.data()};
+  double* a2{a + mm};
+  double* a4{a2 + mm};
+  double* a6{a4 + mm};
+  double* u{a6 + mm};
+  double* v{u + mm};
+  double* w{v + mm};
+
+  double norm{0};
+  for (int j{0}; j < m; ++j) {
+    double column{0};
+    for (int i{0}; i < m; ++i) {
+      column += std::abs(a[j * m + i]);
+    }
+    norm = std::max(norm, column);
+  }
+
+  // Short segments: Taylor polynomial, by Horner's rule.
+  for (int k{1}; k <= 4; ++k) {
+    if (norm <= TAYLOR_THETA[k - 1]) {
+      double* x{u};
+      double* y{v};
+      identity(m, x);
+      for (int i{0}; i < mm; ++i) {
+        x[i] += a[i] / k;
+      }
+      for (int j{k - 1}; j > 0; --j) {
+        identity(m, y);
+        product(m, 1.0 / j, a, x, y, 1);
+        std::swap(x, y);
+      }
+      return x;
+    }
+  }
+
+  // Otherwise the lowest Padé degree accurate enough,
+  // scaling A down by 2^s only beyond the range of degree 13.
+  int degree{13}, squarings{0};
+  for (int d{0}; d < 4; ++d) {
+    if (norm <= PADE_THETA[d]) {
+      degree = PADE_DEGREES[d];
+      break;
+    }
+  }
+  if (degree == 13 && norm > PADE_THETA[4]) {
+    squarings = static_cast<int>(std::ceil(std::log2(norm / PADE_THETA[4])));
+    const double scale{std::ldexp(1.0, -squarings)};
+    for (int k{0}; k < mm; ++k) {
+      a[k] *= scale;
+    }
+  }
+
+  // exp(A) ≈ (V - U)⁻¹ (V + U), with U odd and V even in A.
+  product(m, 1, a, a, a2);
+  if (degree == 13) {
+    const double* b{B13};
+    product(m, 1, a2, a2, a4);
+    product(m, 1, a4, a2, a6);
+    for (int k{0}; k < mm; ++k) {
+      w[k] = b[13] * a6[k] + b[11] * a4[k] + b[9] * a2[k];
+    }
+    product(m, 1, a6, w, u);
+    for (int k{0}; k < mm; ++k) {
+      u[k] += b[7] * a6[k] + b[5] * a4[k] + b[3] * a2[k];
+    }
+    for (int i{0}; i < m; ++i) {
+      u[i * (m + 1)] += b[1];
+    }
+    product(m, 1, a, u, w);
+    std::swap(u, w);
+    for (int k{0}; k < mm; ++k) {
+      w[k] = b[12] * a6[k] + b[10] * a4[k] + b[8] * a2[k];
+    }
+    product(m, 1, a6, w, v);
+    for (int k{0}; k < mm; ++k) {
+      v[k] += b[6] * a6[k] + b[4] * a4[k] + b[2] * a2[k];
+    }
+    for (int i{0}; i < m; ++i) {
+      v[i * (m + 1)] += b[0];
+    }
+  } else {
+    const double* b{degree == 3 ? B3 : degree == 5 ? B5 : degree == 7 ? B7 : B9};
+    // Even powers A^2 .. A^(degree - 1), kept in a2, a4, a6 and u.
+    double* powers[]{a2, a4, a6, u};
+    for (int p{1}; 2 * (p + 1) < degree; ++p) {
+      product(m, 1, powers[p - 1], a2, powers[p]);
+    }
+    identity(m, w, b[1]);
+    identity(m, v, b[0]);
+    for (int p{0}; 2 * (p + 1) < degree + 1; ++p) {
+      const double* power{powers[p]};
+      const double odd{b[2 * p + 3]}, even{b[2 * p + 2]};
+      for (int k{0}; k < mm; ++k) {
+        w[k] += odd * power[k];
+        v[k] += even * power[k];
+      }
+    }
+    product(m, 1, a, w, u);
+  }
+
+  // Solve (V - U) X = V + U, X left in u.
+  for (int k{0}; k < mm; ++k) {
+    const double odd{u[k]};
+    u[k] = v[k] + odd;
+    v[k] -= odd;
+  }
+  int info{0};
+  dgesv_(&m, &m, v, &m, ws.pivots.data(), u, &m, &info);
+  if (info != 0) {
+    std::cerr << "Error: singular Padé denominator in matrix exponential."
+              << std::endl;
+    std::exit(PADE_ERROR);
+  }
+
+  // Squaring: exp(A) = exp(A / 2^s)^(2^s).
+  double* x{u};
+  double* y{v};
+  for (int k{0}; k < squarings; ++k) {
+    product(m, 1, x, x, y);
+    std::swap(x, y);
+  }
+  return x;
+}
+
+} // namespace pade
@@ -0,0 +1,40 @@
+#pragma once
+
+// Dense matrix exponential exp(A), with the cost adapted to the 1-norm of A
+// (Higham, SIAM J. Matrix Anal. Appl. 26(4):1179-1193, 2005):
+//
+//  - tiny norms (very short segments): Taylor polynomial of degree 1 to 4,
+//  - then the diagonal Padé approximant of degree 3, 5, 7 or 9,
+//    the lowest one whose backward error stays below the unit roundoff,
+//  - beyond that, degree 13 on A / 2^s, squared s times.
+//
+// Products and the linear solve go through the BLAS/LAPACK libraries
+// already linked.
+// All the work happens within a workspace owned by the caller,
+// which is only reallocated when the order of the matrices grows.
+
+#include <vector>
+
+namespace pade {
+
+constexpr int PADE_ERROR{6};
+
+class Workspace {
+  int order{0};
+  // A, its even powers, and three more blocks for the odd and even parts
+  // of the approximant, all column-major.
+  std::vector<double> blocks;
+  std::vector<int> pivots;
+
+  friend const double* exp(Workspace& ws);
+
+public:
+  // Column-major A of the given order, to be filled before calling exp().
+  double* argument(int m);
+};
+
+// exp(A) for the argument last set in the workspace, column-major.
+// Points into the workspace: valid until its next use.
+const double* exp(Workspace& ws);
+
+} // namespace pade
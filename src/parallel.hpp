@@ -0,0 +1,46 @@
+#pragma once
+
+// Independent tasks spread over threads spawned for the occasion.
+// Tasks are handed out one index at a time from a shared counter,
+// so uneven tasks (nodes of various sizes, say) still balance across threads.
+// The caller owns the results: each task writes to its own slot
+// of a table allocated beforehand, and nothing else.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// One thread per hardware thread, or 1 if this is unknown.
+inline unsigned int default_threads() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Call task(i) for every i in [0, n), over n_threads threads
+// (default_threads() if 0), the calling one included.
+template <typename F>
+void for_each_index(const size_t n, unsigned int n_threads, const F& task) {
+  if (n_threads == 0) {
+    n_threads = default_threads();
+  }
+  n_threads = static_cast<unsigned int>(std::min<size_t>(n_threads, n));
+  std::atomic<size_t> next{0};
+  const auto work = [&]() {
+    for (size_t i{next++}; i < n; i = next++) {
+      task(i);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int t{1}; t < n_threads; ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace parallel
@@ -0,0 +1,122 @@
+#include "range_index.hpp"
+
+#include <algorithm>
+
+namespace range_index {
+
+Mask mask(const std::vector<int>& range) {
+  Mask m{0};
+  for (size_t area{0}; area < range.size(); ++area) {
+    if (range[area]) {
+      m |= Mask{1} << area;
+    }
+  }
+  return m;
+}
+
+Index::Index(const std::vector<std::vector<int>>& ranges) {
+  if (ranges.empty()) {
+    return;
+  }
+  n_areas = static_cast<int>(ranges[0].size());
+
+  // Grow the dense part one size class at a time,
+  // as long as it stays commensurate with the number of ranges.
+  uint64_t n_slots{1}, class_size{1};
+  dense_max = 0;
+  while (dense_max < n_areas) {
+    class_size = class_size * (n_areas - dense_max) / (dense_max + 1);
+    if (n_slots + class_size > 2 * ranges.size()) {
+      break;
+    }
+    n_slots += class_size;
+    ++dense_max;
+  }
+
+  // Pascal's triangle.
+  const int width{dense_max + 2};
+  binomials.assign((n_areas + 1) * width, 0);
+  for (int n{0}; n <= n_areas; ++n) {
+    binomials[n * width] = 1;
+    for (int k{1}; k < width && k <= n; ++k) {
+      binomials[n * width + k] =
+          binomials[(n - 1) * width + k - 1] + binomials[(n - 1) * width + k];
+    }
+  }
+  offsets.assign(dense_max + 1, 0);
+  for (int k{1}; k <= dense_max; ++k) {
+    offsets[k] = offsets[k - 1] + binomial(n_areas, k - 1);
+  }
+
+  slots.assign(n_slots, -1);
+  for (size_t position{0}; position < ranges.size(); ++position) {
+    const Mask m{mask(ranges[position])};
+    uint64_t rank{0};
+    int k{0};
+    for (int area{0}; area < n_areas; ++area) {
+      if (m >> area & 1) {
+        ++k;
+        if (k <= dense_max) {
+          rank += binomial(area, k);
+        }
+      }
+    }
+    if (k <= dense_max) {
+      int& slot{slots[offsets[k] + rank]};
+      if (slot >= 0) {
+        repeated.emplace_back(m, slot);
+      }
+      slot = static_cast<int>(position);
+    } else {
+      big.emplace_back(m, static_cast<int>(position));
+    }
+  }
+
+  // Keep the last position of every big range, and the first of repeated ones.
+  const auto same_mask{[](const auto& a, const auto& b) {
+    return a.first == b.first;
+  }};
+  std::sort(big.begin(), big.end());
+  for (size_t i{1}; i < big.size(); ++i) {
+    if (big[i].first == big[i - 1].first) {
+      repeated.push_back(big[i - 1]);
+    }
+  }
+  big.erase(big.begin(),
+            std::unique(big.rbegin(), big.rend(), same_mask).base());
+  std::sort(repeated.begin(), repeated.end());
+  repeated.erase(std::unique(repeated.begin(), repeated.end(), same_mask),
+                 repeated.end());
+}
+
+int Index::operator()(const Mask range) const {
+  uint64_t rank{0};
+  int k{0};
+  for (int area{0}; area < n_areas; ++area) {
+    if (range >> area & 1) {
+      if (++k > dense_max) {
+        return find(big, range);
+      }
+      rank += binomial(area, k);
+    }
+  }
+  if ((n_areas < 64 && range >> n_areas != 0) || slots.empty()) {
+    return -1;
+  }
+  return slots[offsets[k] + rank];
+}
+
+int Index::first(const std::vector<int>& range) const {
+  const Mask m{mask(range)};
+  const int position{find(repeated, m)};
+  return position >= 0 ? position : (*this)(m);
+}
+
+int Index::find(const std::vector<std::pair<Mask, int>>& table,
+                const Mask range) {
+  const auto it{std::lower_bound(table.begin(), table.end(),
+                                 std::make_pair(range, -1))};
+  return (it != table.end() && it->first == range) ? it->second : -1;
+}
+
+} // namespace range_index
@@ -0,0 +1,71 @@
+#pragma once
+
+// Arithmetic lookup of the position of a range among the model's ranges,
+// without searching containers keyed by area vectors.
+//
+// A range is read as a bitmask over areas.
+// Within each size class k, the k-subsets of areas are ranked
+// in colexicographic order (combinatorial number system):
+//
+//   rank({c1 < c2 < .. < ck}) = C(c1, 1) + C(c2, 2) + .. + C(ck, k)
+//
+// and size classes are laid one after the other,
+// which gives every range of up to 'dense_max' areas a dense slot.
+// A compact table then translates slots to positions in the model's own
+// ordering of ranges (which needs not be colexicographic,
+// and may leave out some ranges).
+// The few ranges bigger than 'dense_max' (tip ranges bigger than the
+// maximum range size) are looked up in a small sorted table instead.
+//
+// Every lookup is O(n_areas), and never allocates.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace range_index {
+
+// One bit per area.
+using Mask = uint64_t;
+
+// Convert 0/1 area vector to mask.
+Mask mask(const std::vector<int>& range);
+
+class Index {
+  int n_areas{0};
+  int dense_max{-1};
+  // C(n, k) for n in [0, n_areas], k in [0, dense_max + 1].
+  std::vector<uint64_t> binomials;
+  // First slot of every size class.
+  std::vector<uint64_t> offsets;
+  // Slot -> position, -1 if the range is not indexed.
+  std::vector<int> slots;
+  // (mask, position) for ranges bigger than dense_max, sorted by mask.
+  std::vector<std::pair<Mask, int>> big;
+  // (mask, first position) for ranges listed more than once.
+  std::vector<std::pair<Mask, int>> repeated;
+
+  static int find(const std::vector<std::pair<Mask, int>>& table,
+                  Mask range);
+
+  uint64_t binomial(const int n, const int k) const {
+    return binomials[n * (dense_max + 2) + k];
+  }
+
+public:
+  Index() = default;
+  // Index the ranges in the given order.
+  explicit Index(const std::vector<std::vector<int>>& ranges);
+
+  // Position of the range (the last one if repeated),
+  // or -1 if it is not indexed.
+  int operator()(Mask range) const;
+  int operator()(const std::vector<int>& range) const {
+    return (*this)(mask(range));
+  }
+  // Same, but the first position if repeated
+  // (tip ranges bigger than the maximum range size are listed once per tip).
+  int first(const std::vector<int>& range) const;
+};
+
+} // namespace range_index
@@ -38,6 +38,9 @@ parse_file(const File& file, const Areas& areas, const size_t n_periods) {
   // Factorize procedures querying token under focus,
   // assuming it's not EOL/EOF.
   const auto to_double = [&](std::string_view token) -> std::optional<double> {
+    if (token == "?") {
+      return {FREE};
+    }
     try {
       return {std::stod(std::string(token))};
     } catch (std::invalid_argument) {
@@ -100,7 +103,7 @@ parse_file(const File& file, const Areas& areas, const size_t n_periods) {
     not_eof(step);
   };
   const auto is_data = [&](auto& step) -> double {
-    // Check either for literal double or existing variable.
+    // Check either for literal double, free cell or existing variable.
     is_token(step);
     const auto& d{to_double(*step.token)};
     if (d.has_value()) {
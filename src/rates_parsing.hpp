@@ -39,9 +39,14 @@
 //    ~ d * 1 ← modify whole line
 //    ~ * c U ← modify whole column
 //    ~ * * 0 ← modify all values
+//
+//    ~ a c ?  ← '?' leaves the cell free, to be estimated with the rates
+//               (anywhere a number is expected).
 
 #include "lexer.hpp"
 
+#include <cmath>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -53,6 +58,10 @@ using Areas = std::vector<std::string>;
 // Dedicate this code to errors with distribution files.
 constexpr int RATES_ERROR{5};
 
+// Free cells are read as 'not a number'.
+constexpr double FREE{std::numeric_limits<double>::quiet_NaN()};
+inline bool is_free(const double value) { return std::isnan(value); }
+
 RatesMap
 parse_file(const File& file, const Areas& areas, const size_t n_periods);
 
@@ -0,0 +1,57 @@
+#include "replica.hpp"
+
+#include "BranchSegment.h"
+#include "tree_reader.h"
+
+namespace replica {
+
+void preorder(Node& node, std::vector<Node*>& nodes) {
+  nodes.push_back(&node);
+  for (int i{0}; i < node.getChildCount(); ++i) {
+    preorder(node.getChild(i), nodes);
+  }
+}
+
+Replica::Replica(Tree& tree, RateModel& model,
+                 const std::vector<double>& periods,
+                 const scalar::Type scalar_type)
+    : copied_tree{TreeReader().readTree(*tree.getNewickStr())},
+      copied_model{model} {
+  copied_model.stored_p_matrices.clear();
+  engine.reset(new BioGeoTree(copied_tree.get(), periods, scalar_type));
+  engine->set_default_model(&copied_model);
+  preorder(*copied_tree->getRoot(), order);
+}
+
+void Replica::constrain(Tree& original, const bool root_only) {
+  std::vector<Node*> from;
+  preorder(*original.getRoot(), from);
+  for (size_t s{0}; s < (root_only ? 1 : from.size()); ++s) {
+    for (const std::vector<int>& dist : *from[s]->getExclDistVector()) {
+      engine->set_excluded_dist(dist, order[s]);
+    }
+    if (root_only || !from[s]->hasParent()) {
+      continue;
+    }
+    std::vector<BranchSegment>& segments{*from[s]->getSegVector()};
+    std::vector<BranchSegment>& copied{*order[s]->getSegVector()};
+    for (size_t ts{0}; ts < segments.size(); ++ts) {
+      for (const int area : segments[ts].getFossilAreas()) {
+        copied[ts].setFossilArea(area);
+      }
+    }
+  }
+}
+
+void Replica::fix_root(const int range) {
+  Node& root{*copied_tree->getRoot()};
+  root.getExclDistVector()->clear();
+  std::vector<std::vector<int>>& dists{*copied_model.getDists()};
+  for (size_t i{0}; i < dists.size(); ++i) {
+    if (int(i) != range) {
+      engine->set_excluded_dist(dists[i], &root);
+    }
+  }
+}
+
+} // namespace replica
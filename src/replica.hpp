@@ -0,0 +1,62 @@
+#pragma once
+
+// A copy of a tree set up for the likelihood, and of its model,
+// for another analysis to run on a thread of its own
+// (see bootstrap.hpp and root_profile.hpp).
+//
+// The tree is read again from its Newick string, so that its nodes
+// come in the same order as the original's, and the model is copied
+// rather than set up again: ranges, splits, adjacency and dispersal mask
+// are those of the original, only the rates are the copy's own.
+// Node constraints are only carried over on request.
+
+#include "BioGeoTree.h"
+#include "RateModel.h"
+#include "scalar.hpp"
+#include "simulation.hpp"
+#include "tree.h"
+
+#include <memory>
+#include <vector>
+
+namespace replica {
+
+// How the data were analysed, for a replica to be analysed alike.
+struct Analysis {
+  std::vector<double> periods;
+  scalar::Type scalar_type;
+  bool marginal;
+  int max_iterations;
+  double stopping_precision;
+  // Starting values of the estimation.
+  simulation::Rates start;
+};
+
+class Replica {
+  std::unique_ptr<Tree> copied_tree;
+  RateModel copied_model;
+  std::unique_ptr<BioGeoTree> engine;
+  std::vector<Node*> order;
+
+public:
+  // The likelihood engine is set up on the copies, without any tip data.
+  Replica(Tree& tree, RateModel& model, const std::vector<double>& periods,
+          scalar::Type scalar_type);
+
+  Tree& tree() { return *copied_tree; }
+  RateModel& model() { return copied_model; }
+  BioGeoTree& bgt() { return *engine; }
+  // In preorder, node for node with those of the original.
+  const std::vector<Node*>& nodes() const { return order; }
+
+  // Ranges excluded at the nodes of the original (at its root only,
+  // or everywhere along with its fossil branches).
+  void constrain(Tree& original, bool root_only);
+  // Leave the root a single range (a dist int).
+  void fix_root(int range);
+};
+
+// Nodes below this one, itself first, in preorder.
+void preorder(Node& node, std::vector<Node*>& nodes);
+
+} // namespace replica
@@ -0,0 +1,69 @@
+#include "root_profile.hpp"
+
+#include "OptimizeBioGeo.h"
+#include "parallel.hpp"
+#include "superdouble.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace root_profile {
+
+std::vector<Row> at_fixed_rates(BioGeoTree& bgt, RateModel& model) {
+  const std::vector<std::vector<int>>& dists{*model.getDists()};
+  std::vector<Superdouble> conditionals{bgt.root_conditionals()};
+  std::vector<Row> rows;
+  for (size_t i{0}; i < dists.size(); ++i) {
+    // Excluded, out of the period or ruled out alike.
+    if (std::count(dists[i].begin(), dists[i].end(), 1) == 0 ||
+        !(conditionals[i] > Superdouble(0))) {
+      continue;
+    }
+    Row row;
+    row.range = i;
+    row.likelihood = -double(conditionals[i].getLn());
+    rows.push_back(row);
+  }
+  return rows;
+}
+
+void optimize(std::vector<Row>& rows, Tree& tree, RateModel& model,
+              const replica::Analysis& analysis,
+              const std::map<std::string, std::vector<int>>& data,
+              unsigned int n_threads) {
+  if (n_threads == 0) {
+    n_threads = parallel::default_threads();
+  }
+
+  // Set up one after the other, each one then kept by a thread.
+  std::vector<std::unique_ptr<replica::Replica>> workers(
+      std::min<size_t>(n_threads, rows.size()));
+  for (auto& w : workers) {
+    w.reset(new replica::Replica(tree, model, analysis.periods,
+                                 analysis.scalar_type));
+    w->constrain(tree, false);
+    w->bgt().set_tip_conditionals(data);
+  }
+
+  std::atomic<size_t> next{0};
+  parallel::for_each_index(workers.size(), workers.size(), [&](size_t w) {
+    replica::Replica& worker{*workers[w]};
+    for (size_t i{next++}; i < rows.size(); i = next++) {
+      worker.fix_root(rows[i].range);
+      BioGeoTree& bgt{worker.bgt()};
+      OptimizeBioGeo opt(&bgt, &worker.model(), analysis.marginal,
+                         analysis.max_iterations, analysis.stopping_precision);
+      const std::vector<double> rates{opt.optimize_global_dispersal_extinction(
+          analysis.start.dispersal, analysis.start.extinction)};
+      rows[i].rates = simulation::Rates{rates[0], rates[1]};
+      worker.model().setup_D(rates[0]);
+      worker.model().setup_E(rates[1]);
+      worker.model().setup_Q_with_adjacency();
+      bgt.update_default_model(&worker.model());
+      rows[i].optimized = double(bgt.eval_likelihood(analysis.marginal));
+    }
+  });
+}
+
+} // namespace root_profile
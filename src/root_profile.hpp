@@ -0,0 +1,47 @@
+#pragma once
+
+// Likelihood of the data with the root fixed at each of its ranges,
+// that is what one analysis per range with the root as a fixed node gives,
+// but in a single pass.
+//
+// Under the rates of the last likelihood evaluation, the likelihood
+// with the root fixed at a range is the root's conditional for that range,
+// left there by the evaluation. The rates can also be estimated again
+// (simplex) with the root fixed at each range, from the same starting values
+// as the data, the ranges shared out between workers holding their own copy
+// of the tree and of the model (see replica.hpp), under all the node
+// constraints of the data but those at the root.
+
+#include "BioGeoTree.h"
+#include "RateModel.h"
+#include "replica.hpp"
+#include "simulation.hpp"
+#include "tree.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace root_profile {
+
+struct Row {
+  // Dist int of the range.
+  int range{0};
+  // -ln likelihood under the rates of the last evaluation.
+  double likelihood{0};
+  // Only when estimated again, with the -ln likelihood at those rates.
+  simulation::Rates rates{0, 0};
+  double optimized{0};
+};
+
+// Ranges of the root's period, but the empty one, those excluded at the root
+// and those the data rule out, in dist int order.
+std::vector<Row> at_fixed_rates(BioGeoTree& bgt, RateModel& model);
+
+// Rates estimated again for every row, from the data (tip ranges).
+void optimize(std::vector<Row>& rows, Tree& tree, RateModel& model,
+              const replica::Analysis& analysis,
+              const std::map<std::string, std::vector<int>>& data,
+              unsigned int n_threads);
+
+} // namespace root_profile
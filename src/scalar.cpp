@@ -0,0 +1,30 @@
+#include "scalar.hpp"
+
+namespace scalar {
+
+std::optional<Type> parse(const std::string_view name) {
+  if (name == "superdouble") {
+    return Type::Superdouble;
+  }
+  if (name == "long_double") {
+    return Type::LongDouble;
+  }
+  if (name == "double") {
+    return Type::Double;
+  }
+  return {};
+}
+
+std::string_view name(const Type type) {
+  switch (type) {
+  case Type::Superdouble:
+    return "superdouble";
+  case Type::LongDouble:
+    return "long_double";
+  case Type::Double:
+    return "double";
+  }
+  return {};
+}
+
+} // namespace scalar
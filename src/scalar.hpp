@@ -0,0 +1,48 @@
+#pragma once
+
+// Numeric types the likelihood engine (BioGeoTree) can run with,
+// one chosen per run:
+//
+//  - Superdouble: never underflows, the default,
+//  - long double: extended precision on x86, down to about 1e-4951,
+//  - double: the cheapest, down to about 1e-308,
+//    enough for small trees only.
+//
+// Whatever the type, the results leave the engine as Superdouble.
+
+#include "superdouble.h"
+
+#include <cmath>
+#include <optional>
+#include <string_view>
+#include <tuple>
+
+namespace scalar {
+
+// Dedicate this code to a likelihood too small for the chosen type.
+constexpr int UNDERFLOW_ERROR{7};
+
+enum class Type {
+  Superdouble,
+  LongDouble,
+  Double,
+};
+
+// Read the type as named in the config file or on the command line.
+std::optional<Type> parse(std::string_view name);
+constexpr std::string_view NAMES{"'superdouble', 'long_double' and 'double'"};
+std::string_view name(Type type);
+
+// One F<T> for each of the types above, in this order.
+template <template <typename> class F>
+using PerType = std::tuple<F<Superdouble>, F<long double>, F<double>>;
+
+inline Superdouble to_superdouble(const Superdouble& x) { return x; }
+inline Superdouble to_superdouble(const double x) { return Superdouble(x); }
+inline Superdouble to_superdouble(const long double x) {
+  int exponent{0};
+  const double mantissa{static_cast<double>(std::frexp(x, &exponent))};
+  return Superdouble(mantissa, exponent);
+}
+
+} // namespace scalar
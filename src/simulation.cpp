@@ -0,0 +1,239 @@
+#include "simulation.hpp"
+
+#include "BranchSegment.h"
+#include "RateMatrixUtils.h"
+#include "parallel.hpp"
+#include "string_node_object.h"
+
+#include <algorithm>
+#include <cmath>
+#include <gsl/gsl_randist.h>
+
+namespace simulation {
+
+Engine::Engine(Tree& tree, RateModel& model) : model{model} {
+  gsl_rng_env_setup();
+  std::map<Key, int> index;
+  visit(*tree.getRoot(), -1, index);
+
+  Node& root{*tree.getRoot()};
+  const auto& excluded{*root.getExclDistVector()};
+  for (auto& dist : *model.get_incldists_per_period(root.getPeriod())) {
+    const bool allowed{std::count(excluded.begin(), excluded.end(), dist) == 0};
+    root_ranges.push_back(allowed ? model.get_dist_int(dist) : -1);
+  }
+
+  const int n_ranges{static_cast<int>(model.getDists()->size())};
+  for (int period{0}; period < model.get_num_periods(); ++period) {
+    const std::vector<int>& included{*model.get_incldistsint_per_period(period)};
+    positions.emplace_back(n_ranges, -1);
+    for (size_t i{0}; i < included.size(); ++i) {
+      positions.back()[included[i]] = i;
+    }
+  }
+}
+
+void Engine::visit(Node& node, const int parent, std::map<Key, int>& index) {
+  Step step{&node, node.isInternal(), parent, false, node.getPeriod(), {}};
+  if (parent >= 0) {
+    step.left = &node.getParent()->getChild(0) == &node;
+    std::vector<BranchSegment>& crossed{*node.getSegVector()};
+    for (int ts{static_cast<int>(crossed.size()) - 1}; ts >= 0; --ts) {
+      const Segment segment{crossed[ts].getPeriod(), crossed[ts].getDuration(),
+                            ts > 0 ? crossed[ts - 1].getPeriod()
+                                   : node.getPeriod()};
+      const Key key{segment.period, segment.duration, segment.end};
+      const auto found{index.find(key)};
+      if (found == index.end()) {
+        index[key] = segments.size();
+        step.segments.push_back(segments.size());
+        segments.push_back(segment);
+      } else {
+        step.segments.push_back(found->second);
+      }
+    }
+  }
+  const int self{static_cast<int>(steps.size())};
+  steps.push_back(step);
+  for (int i{0}; i < node.getChildCount(); ++i) {
+    visit(node.getChild(i), self, index);
+  }
+}
+
+std::vector<matrix::Matrix> Engine::rate_matrices(const Rates& rates) {
+  model.setup_D(rates.dispersal);
+  model.setup_E(rates.extinction);
+  model.setup_Q_with_adjacency();
+  return model.get_Q();
+}
+
+std::vector<Engine::Transition>
+Engine::transitions(const std::vector<matrix::Matrix>& Q,
+                    const unsigned int n_threads) const {
+  std::vector<Transition> T(segments.size());
+  parallel::for_each_index(segments.size(), n_threads, [&](size_t k) {
+    pade::Workspace ws;
+    Transition& t{T[k]};
+    RateModel::pade_P(Q[segments[k].period], segments[k].duration, ws, t.P);
+    t.rows.resize(t.P.rows());
+    t.built.reset(new std::once_flag[t.P.rows()]);
+  });
+  return T;
+}
+
+int Engine::cross(gsl_rng* r, const int segment, Transition& transition,
+                  const int range) const {
+  const int period{segments[segment].period};
+  const std::vector<int>& following{positions[segments[segment].end]};
+  const int row{range > 0 ? positions[period][range] : -1};
+  if (row < 0) {
+    return 0;
+  }
+  const std::vector<int>& included{*model.get_incldistsint_per_period(period)};
+  std::call_once(transition.built[row], [&]() {
+    std::vector<double> weights(transition.P[row],
+                                transition.P[row] + included.size());
+    std::vector<std::vector<int>>& dists{*model.getDists()};
+    for (size_t j{0}; j < included.size(); ++j) {
+      const std::vector<int>& dist{dists[included[j]]};
+      if (std::count(dist.begin(), dist.end(), 1) == 0 ||
+          following[included[j]] < 0) {
+        weights[j] = 0;
+      }
+    }
+    transition.rows[row] = alias::Table(weights.data(), weights.size());
+  });
+  const alias::Table& table{transition.rows[row]};
+  return table.empty() ? 0 : included[table.draw(gsl_rng_uniform(r))];
+}
+
+void Engine::draw(gsl_rng* r, std::vector<Transition>& transitions,
+                  Replicate& replicate) const {
+  replicate.ranges.assign(steps.size(), 0);
+  replicate.splits.assign(steps.size(), -1);
+  for (size_t s{0}; s < steps.size(); ++s) {
+    const Step& step{steps[s]};
+    int range{0};
+    if (step.parent < 0) {
+      size_t position;
+      do {
+        position = size_t(std::floor(gsl_ran_flat(r, 1, root_ranges.size())));
+      } while (root_ranges[position] < 0);
+      range = root_ranges[position];
+    } else {
+      // Start from the parent's side of its split.
+      const Step& up{steps[step.parent]};
+      const cladogenesis::Splits& splits{model.get_splits_per_period(up.period)};
+      const int split{replicate.splits[step.parent]};
+      if (split >= 0) {
+        const int k{splits.first(replicate.ranges[step.parent]) + split};
+        range = step.left ? splits.left_of(k) : splits.right_of(k);
+      }
+      for (const int segment : step.segments) {
+        range = cross(r, segment, transitions[segment], range);
+      }
+    }
+    replicate.ranges[s] = range;
+    if (step.internal) {
+      const int n_splits{
+          model.get_splits_per_period(step.period).n_splits(range)};
+      if (n_splits > 0) {
+        replicate.splits[s] = int(gsl_rng_uniform_int(r, n_splits));
+      }
+    }
+  }
+}
+
+std::vector<Replicate> run(std::vector<Engine>& engines, const int replicates,
+                           const size_t first, const size_t n,
+                           const unsigned long seed,
+                           const std::optional<Rates>& rates,
+                           const unsigned int n_threads) {
+  if (n == 0) {
+    return {};
+  }
+  // Draw the rates first, and set up their rate matrices,
+  // which goes through the model and so one pair at a time.
+  std::vector<Replicate> drawn(n);
+  std::vector<gsl_rng*> streams(n);
+  std::vector<std::vector<matrix::Matrix>> Q(rates.has_value() ? 0 : n);
+  for (size_t i{0}; i < n; ++i) {
+    Replicate& replicate{drawn[i]};
+    const size_t pair{first + i};
+    replicate.tree = pair / replicates;
+    replicate.number = pair % replicates + 1;
+    replicate.seed = seed + pair;
+    streams[i] = gsl_rng_alloc(gsl_rng_default);
+    gsl_rng_set(streams[i], replicate.seed);
+    if (rates.has_value()) {
+      replicate.rates = *rates;
+      continue;
+    }
+    Rates& random{replicate.rates};
+    do {
+      random.dispersal = gsl_ran_flat(streams[i], 0, 1) * 0.2;
+      random.extinction = gsl_ran_flat(streams[i], 0, 1) * 0.2;
+    } while ((random.dispersal != 0) && (random.extinction != 0) &&
+             (random.dispersal <= random.extinction));
+    Q[i] = engines[replicate.tree].rate_matrices(random);
+  }
+
+  // Given rates: the rate matrices are the same for all trees,
+  // only the transitions of the segments differ.
+  const int front{drawn.front().tree};
+  const int back{drawn.back().tree};
+  if (rates.has_value()) {
+    std::vector<matrix::Matrix> shared_Q;
+    for (int t{front}; t <= back; ++t) {
+      Engine& engine{engines[t]};
+      if (engine.shared_rates.has_value() &&
+          engine.shared_rates->dispersal == rates->dispersal &&
+          engine.shared_rates->extinction == rates->extinction) {
+        continue;
+      }
+      if (shared_Q.empty()) {
+        shared_Q = engine.rate_matrices(*rates);
+      }
+      engine.shared = engine.transitions(shared_Q, n_threads);
+      engine.shared_rates = rates;
+    }
+  }
+
+  parallel::for_each_index(n, n_threads, [&](size_t i) {
+    Engine& engine{engines[drawn[i].tree]};
+    if (rates.has_value()) {
+      engine.draw(streams[i], engine.shared, drawn[i]);
+    } else {
+      std::vector<Engine::Transition> own{engine.transitions(Q[i], 1)};
+      engine.draw(streams[i], own, drawn[i]);
+    }
+    gsl_rng_free(streams[i]);
+  });
+
+  // Trees whose last pair was drawn no longer need their transitions.
+  for (int t{front}; t <= back; ++t) {
+    if (size_t(t + 1) * replicates <= first + n) {
+      engines[t].shared.clear();
+      engines[t].shared_rates.reset();
+    }
+  }
+  return drawn;
+}
+
+void Engine::record(const Replicate& replicate) const {
+  std::vector<std::vector<int>>& dists{*model.getDists()};
+  for (size_t s{0}; s < steps.size(); ++s) {
+    Node& node{*steps[s].node};
+    int range{replicate.ranges[s]};
+    std::vector<int> dist{range > 0 ? dists[range] : std::vector<int>{}};
+    StringNodeObject state(print_area_vector(dist, *model.get_areanamemaprev()));
+    node.assocObject("simstate", state);
+    node.setIntObject("simdistidx", range);
+    if (replicate.splits[s] >= 0) {
+      int split{replicate.splits[s]};
+      node.setIntObject("simsplit", split);
+    }
+  }
+}
+
+} // namespace simulation
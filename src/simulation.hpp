@@ -0,0 +1,145 @@
+#pragma once
+
+// Forward simulation of ranges down a tree, replicate after replicate.
+//
+// The range at the root is drawn uniformly among the included ones,
+// then every internal node draws one of the splits of its range
+// (all equally likely, as in the likelihood),
+// and each descendant branch starts from its side of the split.
+// Along a branch, the range at the end of every segment is drawn
+// from the row of its transition probabilities P for the range at its start,
+// leaving out the empty range since the lineage is known to survive,
+// and the ranges excluded from the period that follows.
+// Rows are drawn from with alias tables (see alias.hpp),
+// built the first time a lineage starts from them.
+//
+// Transition probabilities only depend on the rates and on the period
+// and duration of a segment, so they are computed once per distinct segment
+// of a tree and set of rates, shared by all replicates of the tree
+// when the rates are given.
+//
+// Several trees (a posterior sample, say) are simulated together,
+// each by its own engine: replicate k of tree t makes the pair
+// t * replicates + k - 1, and pairs are drawn in parallel whatever their tree,
+// each one from its own generator seeded with seed plus its pair number,
+// so that results do not depend on the number of threads
+// (and the first tree gets the same seeds as it would alone).
+
+#include "RateModel.h"
+#include "alias.hpp"
+#include "matrix.hpp"
+#include "tree.h"
+
+#include <gsl/gsl_rng.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace simulation {
+
+struct Rates {
+  double dispersal;
+  double extinction;
+};
+
+// Outcome of one replicate.
+struct Replicate {
+  // Tree (index among the engines) and replicate number, from 1.
+  int tree{0};
+  int number{0};
+  unsigned long seed{0};
+  Rates rates{0, 0};
+  // For each node, in the order of the engine:
+  // the range reached (dist int, 0 if none could be)
+  // and the split drawn within it (-1 at the tips, or without any split).
+  std::vector<int> ranges;
+  std::vector<int> splits;
+};
+
+class Engine;
+
+// Pairs first .. first + n - 1, of that many replicates per tree,
+// under the given rates or rates drawn at random for each.
+// The transitions of a tree under given rates are kept from one call
+// to the next, until the last of its pairs is drawn.
+std::vector<Replicate> run(std::vector<Engine>& engines, int replicates,
+                           size_t first, size_t n, unsigned long seed,
+                           const std::optional<Rates>& rates,
+                           unsigned int n_threads);
+
+class Engine {
+  // One node, visited after its parent.
+  // Drawing only reads steps, never the nodes themselves,
+  // which are left to record() (and to output, meanwhile).
+  struct Step {
+    Node* node;
+    bool internal;
+    int parent;
+    // Child 0 of its parent, starting from the left side of the split.
+    bool left;
+    int period;
+    // Distinct segments along the branch, in the order they are crossed
+    // from the parent.
+    std::vector<int> segments;
+  };
+
+  // Distinct segments, by period, duration,
+  // and period at their end (that of the next segment, or of the node).
+  struct Segment {
+    int period;
+    double duration;
+    int end;
+  };
+  using Key = std::tuple<int, double, int>;
+
+  RateModel& model;
+  std::vector<Step> steps;
+  std::vector<Segment> segments;
+  // Ranges the root can be drawn from, within the included ones
+  // of its period (-1 where excluded at the root).
+  std::vector<int> root_ranges;
+  // Position of every range among the included ones of each period
+  // (-1 where excluded).
+  std::vector<std::vector<int>> positions;
+
+  // Transition probabilities of a segment,
+  // and the alias tables of its rows, each built once by whichever
+  // replicate first needs it.
+  struct Transition {
+    matrix::Matrix P;
+    std::vector<alias::Table> rows;
+    std::unique_ptr<std::once_flag[]> built;
+  };
+  // Transitions of the segments under given rates, kept by run().
+  std::vector<Transition> shared;
+  std::optional<Rates> shared_rates;
+
+  void visit(Node& node, int parent, std::map<Key, int>& index);
+  // Rate matrices for these rates, one per period.
+  std::vector<matrix::Matrix> rate_matrices(const Rates& rates);
+  std::vector<Transition> transitions(const std::vector<matrix::Matrix>& Q,
+                                      unsigned int n_threads) const;
+  // Range at the end of a segment, from the one at its start.
+  int cross(gsl_rng* r, int segment, Transition& transition, int range) const;
+  void draw(gsl_rng* r, std::vector<Transition>& transitions,
+            Replicate& replicate) const;
+
+public:
+  // The tree and the model must outlive the engine.
+  Engine(Tree& tree, RateModel& model);
+
+  friend std::vector<Replicate> run(std::vector<Engine>& engines,
+                                    int replicates, size_t first, size_t n,
+                                    unsigned long seed,
+                                    const std::optional<Rates>& rates,
+                                    unsigned int n_threads);
+
+  // Attach the ranges of a replicate to the nodes, for output:
+  // "simstate" (area names), "simdistidx" (dist int) and "simsplit".
+  void record(const Replicate& replicate) const;
+};
+
+} // namespace simulation
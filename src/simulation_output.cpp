@@ -0,0 +1,126 @@
+#include "simulation_output.hpp"
+
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace simulation {
+
+Writer::Writer(const std::vector<Engine>& engines,
+               const std::vector<Tree*>& trees, RateModel& model,
+               const int replicates, const config::SimulationOutput output)
+    : engines{engines}, trees{trees}, model{model}, replicates{replicates},
+      output{output} {
+  if (output == config::SimulationOutput::Combined) {
+    tree_file.open("SimTree.tre");
+    distrib_file.open("SimDistrib.txt");
+    states_file.open("SimStates.txt");
+  }
+  thread = std::thread(&Writer::work, this);
+}
+
+Writer::~Writer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    closing = true;
+  }
+  changed.notify_all();
+  thread.join();
+}
+
+void Writer::push(std::vector<Replicate> block) {
+  std::unique_lock<std::mutex> lock(mutex);
+  changed.wait(lock, [&]() { return pending.size() < max_pending; });
+  pending.push_back(std::move(block));
+  lock.unlock();
+  changed.notify_all();
+}
+
+void Writer::work() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    changed.wait(lock, [&]() { return !pending.empty() || closing; });
+    if (pending.empty()) {
+      return;
+    }
+    std::vector<Replicate> block{std::move(pending.front())};
+    pending.pop_front();
+    lock.unlock();
+    changed.notify_all();
+    for (const Replicate& replicate : block) {
+      write(replicate);
+    }
+    lock.lock();
+  }
+}
+
+void Writer::emit(std::ofstream& combined, const std::string& base,
+                  const std::string& extension, const std::string& label,
+                  const std::string& record, const bool header) {
+  if (output == config::SimulationOutput::Combined) {
+    if (header) {
+      combined << "# " << label << '\n';
+    }
+    combined << record;
+    return;
+  }
+  const bool alone{trees.size() == 1 && replicates == 1};
+  std::ofstream file(base + (alone ? "" : "." + label) + extension);
+  file << record;
+}
+
+void Writer::write(const Replicate& replicate) {
+  Tree& tree{*trees[replicate.tree]};
+  engines[replicate.tree].record(replicate);
+
+  std::string label{std::to_string(replicate.number)};
+  if (trees.size() > 1) {
+    label = std::to_string(replicate.tree + 1) + "." + label;
+  }
+  if (trees.size() > 1 || replicates > 1) {
+    std::cout << label << "\t";
+  }
+  std::cout << "dispersal : " << replicate.rates.dispersal
+            << "\textinction : " << replicate.rates.extinction
+            << "\tseed : " << replicate.seed;
+
+  // Simulated states at the nodes, in Newick format.
+  emit(tree_file, "SimTree", ".tre", label,
+       tree.getRoot()->getNewick(true, "simstate") + ";\n", false);
+
+  // Leaf distributions.
+  std::map<int, std::vector<int>>& dists{*model.get_int_dists_map()};
+  std::set<std::vector<int>> leaf_dists;
+  std::ostringstream distrib;
+  distrib << tree.getExternalNodeCount() << " " << model.get_num_areas()
+          << '\n';
+  for (int i{0}; i < tree.getExternalNodeCount(); ++i) {
+    Node& tip{*tree.getExternalNode(i)};
+    const std::vector<int>& dist{dists[*tip.getIntObject("simdistidx")]};
+    distrib << tip.getName() << "\t";
+    for (const int a : dist) {
+      distrib << a;
+    }
+    distrib << '\n';
+    leaf_dists.insert(dist);
+  }
+  emit(distrib_file, "SimDistrib", ".txt", label, distrib.str(), true);
+
+  // Interior node distributions, after the rates.
+  std::ostringstream states;
+  states << replicate.rates.dispersal << '\n'
+         << replicate.rates.extinction << '\n';
+  for (int i{0}; i < tree.getInternalNodeCount(); ++i) {
+    Node& node{*tree.getInternalNode(i)};
+    states << node.getNumber() << "\t";
+    for (const int a : dists[*node.getIntObject("simdistidx")]) {
+      states << a;
+    }
+    states << '\n';
+  }
+  emit(states_file, "SimStates", ".txt", label, states.str(), true);
+
+  std::cout << "\tleaf_dists : " << leaf_dists.size() << std::endl;
+}
+
+} // namespace simulation
@@ -0,0 +1,72 @@
+#pragma once
+
+// Output of simulated replicates, formatted and written by a thread
+// of its own while the following ones are being simulated.
+//
+// Each replicate is labelled by its number, preceded by that of its tree
+// when there are several ("2.17" for replicate 17 of tree 2).
+// Replicates are either written to three files each,
+// SimTree.<label>.tre, SimDistrib.<label>.txt and SimStates.<label>.txt
+// (SimTree.tre, etc. for a single replicate of a single tree),
+// or streamed into the same three files for all of them:
+// SimTree.tre with one tree per line, one replicate after the other,
+// and SimDistrib.txt and SimStates.txt where each replicate's record
+// starts with a "# <label>" line.
+
+#include "RateModel.h"
+#include "config_parsing.hpp"
+#include "simulation.hpp"
+#include "tree.h"
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace simulation {
+
+class Writer {
+  // Engines and trees, one for one, and the model they share.
+  const std::vector<Engine>& engines;
+  const std::vector<Tree*>& trees;
+  RateModel& model;
+  const int replicates;
+  const config::SimulationOutput output;
+
+  // Files of the combined output.
+  std::ofstream tree_file;
+  std::ofstream distrib_file;
+  std::ofstream states_file;
+
+  // Blocks of replicates handed over and not yet taken by the thread,
+  // a couple at most so that simulation does not run too far ahead.
+  static constexpr size_t max_pending{2};
+  std::deque<std::vector<Replicate>> pending;
+  bool closing{false};
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::thread thread;
+
+  void work();
+  void write(const Replicate& replicate);
+  // Write one record: to the combined file, or to its own.
+  void emit(std::ofstream& combined, const std::string& base,
+            const std::string& extension, const std::string& label,
+            const std::string& record, bool header);
+
+public:
+  // The engines, trees and model must outlive the writer.
+  Writer(const std::vector<Engine>& engines, const std::vector<Tree*>& trees,
+         RateModel& model, int replicates, config::SimulationOutput output);
+  // Once everything handed over is written.
+  ~Writer();
+
+  // Write out these replicates after the ones handed over before,
+  // waiting first if the writer is too far behind.
+  void push(std::vector<Replicate> block);
+};
+
+} // namespace simulation
@@ -0,0 +1,294 @@
+#include "stochastic_mapping.hpp"
+
+#include "BranchSegment.h"
+#include "parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace stochastic_mapping {
+
+namespace {
+
+// The number of jumps along a segment is drawn among those
+// up to where the Poisson tail left out weighs less than this,
+// and in any case no more than MAX_JUMPS.
+constexpr double TAIL{1e-12};
+constexpr int MAX_JUMPS{100000};
+
+} // namespace
+
+Mapper::Mapper(Tree& tree, BioGeoTree& bgt, RateModel& model) : model{model} {
+  gsl_rng_env_setup();
+  visit(*tree.getRoot(), -1, bgt);
+
+  const int n_ranges{static_cast<int>(model.getDists()->size())};
+  const std::vector<matrix::Matrix>& Q{model.get_Q()};
+  for (int period{0}; period < model.get_num_periods(); ++period) {
+    const std::vector<int>& included{*model.get_incldistsint_per_period(period)};
+    positions.emplace_back(n_ranges, -1);
+    for (size_t i{0}; i < included.size(); ++i) {
+      positions.back()[included[i]] = i;
+    }
+
+    const matrix::Matrix& q{Q[period]};
+    const int m{q.rows()};
+    Uniformized u{0, matrix::Matrix(m, m)};
+    for (int i{0}; i < m; ++i) {
+      u.mu = std::max(u.mu, -q[i][i]);
+    }
+    for (int i{0}; i < m; ++i) {
+      for (int j{0}; j < m; ++j) {
+        u.R[i][j] = (i == j ? 1 : 0) + (u.mu > 0 ? q[i][j] / u.mu : 0);
+      }
+    }
+    uniformized.push_back(std::move(u));
+  }
+}
+
+void Mapper::visit(Node& node, const int parent, BioGeoTree& bgt) {
+  Step step{&node, parent, false, node.isInternal(), node.getPeriod(), {}, {},
+            {}};
+  if (parent >= 0) {
+    step.left = &node.getParent()->getChild(0) == &node;
+    std::vector<BranchSegment>& segments{*node.getSegVector()};
+    step.top = bgt.relative_conditionals(node, segments.size());
+    for (int ts{static_cast<int>(segments.size()) - 1}; ts >= 0; --ts) {
+      const int period{segments[ts].getPeriod()};
+      const double duration{segments[ts].getDuration()};
+      step.segments.push_back({period, duration,
+                               model.stored_p_matrices[period][duration],
+                               bgt.relative_conditionals(node, ts)});
+    }
+  } else {
+    step.top = bgt.relative_conditionals(node, 0);
+  }
+  const int self{static_cast<int>(steps.size())};
+  steps.push_back(std::move(step));
+  for (int i{0}; i < node.getChildCount(); ++i) {
+    steps[self].children.push_back(steps.size());
+    visit(node.getChild(i), self, bgt);
+  }
+}
+
+int Mapper::pick(gsl_rng* r, const double* weights, const int n) {
+  double total{0};
+  for (int i{0}; i < n; ++i) {
+    total += weights[i];
+  }
+  double u{gsl_rng_uniform(r) * total};
+  int last{-1};
+  for (int i{0}; i < n; ++i) {
+    if (weights[i] > 0) {
+      if (u < weights[i]) {
+        return i;
+      }
+      u -= weights[i];
+      last = i;
+    }
+  }
+  // Only reached through rounding, or without any weight.
+  return last;
+}
+
+void Mapper::history(gsl_rng* r, const Segment& segment, const int from,
+                     const int to, Branch& branch) const {
+  const std::vector<int>& included{
+      *model.get_incldistsint_per_period(segment.period)};
+  const std::vector<std::vector<int>>& dists{*model.getDists()};
+  const Uniformized& u{uniformized[segment.period]};
+  const int m{u.R.rows()};
+  const int x{positions[segment.period][from]};
+  const int y{positions[segment.period][to]};
+
+  // Weights of n jumps (virtual ones included): Poisson(mu t)[n] R^n[x][y].
+  const double lambda{u.mu * segment.duration};
+  std::vector<double> weights;
+  std::vector<double> row(m, 0);
+  std::vector<double> next(m);
+  row[x] = 1;
+  double log_poisson{-lambda};
+  double mass{0};
+  for (int n{0};; ++n) {
+    const double poisson{std::exp(log_poisson)};
+    weights.push_back(poisson * row[y]);
+    mass += poisson;
+    if ((mass >= 1 - TAIL && n >= lambda) || n >= MAX_JUMPS) {
+      break;
+    }
+    std::fill(next.begin(), next.end(), 0.0);
+    for (int i{0}; i < m; ++i) {
+      if (row[i] != 0) {
+        const double* Ri{u.R[i]};
+        for (int j{0}; j < m; ++j) {
+          next[j] += row[i] * Ri[j];
+        }
+      }
+    }
+    row.swap(next);
+    log_poisson += std::log(lambda) - std::log(n + 1.0);
+  }
+  int n{pick(r, weights.data(), weights.size())};
+  if (n < 0) {
+    n = x != y ? 1 : 0;
+  }
+
+  // Every jump is drawn from its row of R, weighted by R^j[., y]
+  // for the j jumps left after it.
+  std::vector<std::vector<double>> towards(n);
+  if (n > 0) {
+    towards[0].assign(m, 0);
+    towards[0][y] = 1;
+  }
+  for (int j{1}; j < n; ++j) {
+    towards[j].assign(m, 0);
+    for (int i{0}; i < m; ++i) {
+      const double* Ri{u.R[i]};
+      for (int l{0}; l < m; ++l) {
+        towards[j][i] += Ri[l] * towards[j - 1][l];
+      }
+    }
+  }
+  std::vector<double> times(n);
+  for (double& time : times) {
+    time = gsl_rng_uniform(r) * segment.duration;
+  }
+  std::sort(times.begin(), times.end());
+
+  const auto dwell = [&](const int state, const double time) {
+    const std::vector<int>& dist{dists[included[state]]};
+    for (size_t a{0}; a < dist.size(); ++a) {
+      if (dist[a] == 1) {
+        branch.dwelling[a] += time;
+      }
+    }
+  };
+  int state{x};
+  double last{0};
+  std::vector<double> jump(m);
+  for (int k{0}; k < n; ++k) {
+    const double* Rs{u.R[state]};
+    for (int z{0}; z < m; ++z) {
+      jump[z] = Rs[z] * towards[n - k - 1][z];
+    }
+    int reached{pick(r, jump.data(), m)};
+    if (reached < 0) {
+      reached = y;
+    }
+    dwell(state, times[k] - last);
+    last = times[k];
+    if (reached != state) {
+      const std::vector<int>& before{dists[included[state]]};
+      const std::vector<int>& after{dists[included[reached]]};
+      for (size_t a{0}; a < before.size(); ++a) {
+        branch.dispersals += after[a] > before[a];
+        branch.extinctions += after[a] < before[a];
+      }
+    }
+    state = reached;
+  }
+  dwell(state, segment.duration - last);
+}
+
+void Mapper::map(gsl_rng* r, std::vector<Branch>& branches) const {
+  const int n_areas{model.get_num_areas()};
+  branches.assign(steps.size(), Branch{0, 0, std::vector<double>(n_areas, 0)});
+  // Split drawn at every node
+  // (its index among all the splits of the period).
+  std::vector<int> splits(steps.size(), -1);
+  for (size_t s{0}; s < steps.size(); ++s) {
+    const Step& step{steps[s]};
+    int range{0};
+    if (step.parent < 0) {
+      range = std::max(0, pick(r, step.top.data(), step.top.size()));
+    } else {
+      // Start from the parent's side of its split.
+      const Step& up{steps[step.parent]};
+      const cladogenesis::Splits& above{model.get_splits_per_period(up.period)};
+      const int k{splits[step.parent]};
+      if (k >= 0) {
+        range = step.left ? above.left_of(k) : above.right_of(k);
+      }
+      for (const Segment& segment : step.segments) {
+        const std::vector<int>& included{
+            *model.get_incldistsint_per_period(segment.period)};
+        const int row{positions[segment.period][range]};
+        if (row < 0) {
+          break;
+        }
+        std::vector<double> weights(included.size());
+        for (size_t j{0}; j < included.size(); ++j) {
+          weights[j] = segment.P[row][j] * segment.end[included[j]];
+        }
+        const int end{pick(r, weights.data(), weights.size())};
+        if (end < 0) {
+          break;
+        }
+        history(r, segment, range, included[end], branches[s]);
+        range = included[end];
+      }
+    }
+    if (step.internal) {
+      const cladogenesis::Splits& here{
+          model.get_splits_per_period(step.period)};
+      const std::vector<double>& left{steps[step.children[0]].top};
+      const std::vector<double>& right{steps[step.children[1]].top};
+      const int first{here.first(range)};
+      std::vector<double> weights(here.n_splits(range));
+      for (size_t i{0}; i < weights.size(); ++i) {
+        weights[i] = left[here.left_of(first + i)] *
+                     right[here.right_of(first + i)];
+      }
+      const int split{pick(r, weights.data(), weights.size())};
+      if (split >= 0) {
+        splits[s] = first + split;
+      }
+    }
+  }
+}
+
+Summary Mapper::run(const int maps, const unsigned long seed,
+                    const unsigned int n_threads) const {
+  const int n_areas{model.get_num_areas()};
+  Summary summary;
+  summary.maps = maps;
+  for (const Step& step : steps) {
+    summary.nodes.push_back(step.node);
+  }
+  summary.dispersals.assign(steps.size(), 0);
+  summary.extinctions.assign(steps.size(), 0);
+  summary.dwelling.assign(steps.size(), std::vector<double>(n_areas, 0));
+
+  // A block of maps at a time, to bound their memory.
+  const int block{256};
+  std::vector<std::vector<Branch>> drawn(block);
+  for (int first{0}; first < maps; first += block) {
+    const int n{std::min(block, maps - first)};
+    parallel::for_each_index(n, n_threads, [&](size_t i) {
+      gsl_rng* r{gsl_rng_alloc(gsl_rng_default)};
+      gsl_rng_set(r, seed + first + i);
+      map(r, drawn[i]);
+      gsl_rng_free(r);
+    });
+    for (int i{0}; i < n; ++i) {
+      for (size_t s{0}; s < steps.size(); ++s) {
+        const Branch& branch{drawn[i][s]};
+        summary.dispersals[s] += branch.dispersals;
+        summary.extinctions[s] += branch.extinctions;
+        for (int a{0}; a < n_areas; ++a) {
+          summary.dwelling[s][a] += branch.dwelling[a];
+        }
+      }
+    }
+  }
+  for (size_t s{0}; s < steps.size(); ++s) {
+    summary.dispersals[s] /= maps;
+    summary.extinctions[s] /= maps;
+    for (double& time : summary.dwelling[s]) {
+      time /= maps;
+    }
+  }
+  return summary;
+}
+
+} // namespace stochastic_mapping
@@ -0,0 +1,109 @@
+#pragma once
+
+// Stochastic mapping: histories of dispersal and extinction
+// along the branches, drawn given the data, under the rates
+// of the last likelihood evaluation.
+//
+// Ranges are first drawn down the tree from the conditionals
+// that evaluation left (see BioGeoTree::relative_conditionals):
+// the one at the root from its conditionals,
+// a split of every node's range from the conditionals at the top
+// of both branches below, and the range at the end of each segment
+// from the row of its stored P for the range at its start,
+// weighted by the conditionals at the end.
+//
+// The history along a segment is then drawn given both ends
+// by uniformization (Hobolth and Stone, 2009): with mu the largest rate
+// of leaving a range and R = I + Q / mu, the number of jumps n is drawn
+// from Poisson(mu t) weighted by R^n[start][end], their times uniformly,
+// and every jump from its row of R weighted by the powers of R
+// left towards the end, a jump to the same range being no event at all.
+//
+// Maps run in parallel, each one drawing from its own generator
+// seeded with seed + map - 1, and are summed up in map order,
+// so that results do not depend on the number of threads.
+
+#include "BioGeoTree.h"
+#include "RateModel.h"
+#include "matrix.hpp"
+#include "tree.h"
+
+#include <gsl/gsl_rng.h>
+#include <vector>
+
+namespace stochastic_mapping {
+
+// Means over the maps, for the branch above every node
+// (in the order of the mapper's nodes, the root's branch left at zero).
+struct Summary {
+  int maps{0};
+  std::vector<Node*> nodes;
+  std::vector<double> dispersals;
+  std::vector<double> extinctions;
+  // Time spent in each area.
+  std::vector<std::vector<double>> dwelling;
+};
+
+class Mapper {
+  // One segment of a branch, with its P (the stored one)
+  // and the conditionals at its end.
+  struct Segment {
+    int period;
+    double duration;
+    matrix::View P;
+    std::vector<double> end;
+  };
+
+  // One node, visited after its parent.
+  struct Step {
+    Node* node;
+    int parent;
+    // Child 0 of its parent, starting from the left side of the split.
+    bool left;
+    bool internal;
+    int period;
+    // Conditionals at the top of the branch above (at the root, its own).
+    std::vector<double> top;
+    // Segments of the branch above, from the top down.
+    std::vector<Segment> segments;
+    std::vector<int> children;
+  };
+
+  // Uniformized rate matrix of a period: R = I + Q / mu.
+  struct Uniformized {
+    double mu;
+    matrix::Matrix R;
+  };
+
+  // What a map went through along one branch.
+  struct Branch {
+    int dispersals{0};
+    int extinctions{0};
+    std::vector<double> dwelling;
+  };
+
+  RateModel& model;
+  std::vector<Step> steps;
+  std::vector<Uniformized> uniformized;
+  // Position of every range among the included ones of each period
+  // (-1 where excluded).
+  std::vector<std::vector<int>> positions;
+
+  void visit(Node& node, int parent, BioGeoTree& bgt);
+  // Index drawn in proportion to the weights (which do not sum to 0).
+  static int pick(gsl_rng* r, const double* weights, int n);
+  // History along a segment, between two ranges (dist ints).
+  void history(gsl_rng* r, const Segment& segment, int from, int to,
+               Branch& branch) const;
+  void map(gsl_rng* r, std::vector<Branch>& branches) const;
+
+public:
+  // Right after the likelihood evaluation with P matrices stored
+  // (see BioGeoTree::set_store_p_matrices),
+  // which the tree, the model and their P must outlive.
+  Mapper(Tree& tree, BioGeoTree& bgt, RateModel& model);
+
+  Summary run(int maps, unsigned long seed, unsigned int n_threads) const;
+};
+
+} // namespace stochastic_mapping
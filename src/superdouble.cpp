@@ -2,15 +2,67 @@
 #include "superdouble.h"
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <cstdint>
 #include <cmath>
 #include <iostream>
 using namespace std;
 
+static_assert(sizeof(Superdouble) == 16, "a Superdouble should stay a double and an int");
+
+/*
+ * fields of a binary64 double
+ */
+static const int MANTISSA_BITS = 52;
+static const int HALF_BIASED_EXPONENT = 1022;	//	biased exponent of [0.5, 1)
+static const uint64_t EXPONENT_FIELD = uint64_t(0x7ff) << MANTISSA_BITS;
+
+/*
+ * below 2^-60 relative to the other term, a term does not change a sum
+ */
+static const int NEGLIGIBLE_EXPONENT = -60;
+
+static inline uint64_t to_bits(double d){
+	uint64_t bits;
+	memcpy(&bits,&d,sizeof(bits));
+	return bits;
+}
+
+static inline double from_bits(uint64_t bits){
+	double d;
+	memcpy(&d,&bits,sizeof(d));
+	return d;
+}
+
+/*
+ * 2^e, for NEGLIGIBLE_EXPONENT <= e <= 0
+ */
+static inline double power_of_two(int e){
+	return from_bits(uint64_t(HALF_BIASED_EXPONENT + 1 + e) << MANTISSA_BITS);
+}
+
+/*
+ * m1 * 2^e1 + m2 * 2^e2 for normalized terms, aligned on the larger exponent
+ */
+static inline Superdouble add(double m1, int e1, double m2, int e2){
+	if (m2 == 0)
+		return Superdouble(m1,e1);
+	if (m1 == 0)
+		return Superdouble(m2,e2);
+	if (e1 < e2){
+		swap(m1,m2);
+		swap(e1,e2);
+	}
+	int exponentdif = e2-e1;
+	if (exponentdif < NEGLIGIBLE_EXPONENT)
+		return Superdouble(m1,e1);
+	return Superdouble(m1+m2*power_of_two(exponentdif),e1);
+}
 
-Superdouble::Superdouble(long double m, int e):stilldouble(false),upperlimit(1e+100),lowerlimit(1e-100){
+Superdouble::Superdouble(double m, int e){
 	mantissa=m;
 	exponent=e;
-	adjustDecimal();
+	normalize();
 }
 
 Superdouble::~Superdouble() {}
@@ -23,27 +75,39 @@ double Superdouble::getMantissa(){
 	return mantissa;
 }
 
-void Superdouble::adjustDecimal() {
-	stilldouble = false;
-	if (mantissa==0 || isinf(mantissa) || isnan(mantissa)) {
+/*
+ * move the binary exponent of the mantissa into exponent,
+ * leaving 0.5 <= |mantissa| < 1
+ */
+void Superdouble::normalize() {
+	uint64_t bits = to_bits(mantissa);
+	uint64_t field = bits & EXPONENT_FIELD;
+	if (field != 0 && field != EXPONENT_FIELD){
+		exponent += int(field >> MANTISSA_BITS) - HALF_BIASED_EXPONENT;
+		mantissa = from_bits((bits & ~EXPONENT_FIELD) | (uint64_t(HALF_BIASED_EXPONENT) << MANTISSA_BITS));
+	}
+	else if (mantissa==0 || isinf(mantissa) || isnan(mantissa)) {
 		exponent=0;
-		stilldouble = true;
 	}
-	else {
-		while (fabs(mantissa)>=10) {
-			mantissa*=0.1;
-			exponent+=1;
-		}
-		while (fabs(mantissa)<1) {
-			mantissa*=10.0;
-			exponent+=-1;
-		}
+	else {	//	subnormal
+		int e;
+		mantissa = frexp(mantissa,&e);
+		exponent += e;
 	}
 }
 
+/*
+ * printed in base 10, as mantissa e exponent
+ */
 ostream& operator<<(ostream& os, const Superdouble& x)
 {
-	os<<x.mantissa <<"e"<<x.exponent;
+	if (x.mantissa==0 || isinf(x.mantissa) || isnan(x.mantissa)) {
+		os<<x.mantissa;
+		return os;
+	}
+	double log10value = log10(fabs(x.mantissa))+x.exponent*log10(2.0);
+	double exponent10 = floor(log10value);
+	os<<copysign(pow(10.,log10value-exponent10),x.mantissa) <<"e"<<exponent10;
 	return os;
 }
 
@@ -55,200 +119,80 @@ Superdouble Superdouble::operator * ( double  x){
 	return Superdouble(mantissa*x, exponent);
 }
 
-
-//add stilldouble
 Superdouble Superdouble::operator / ( Superdouble  x){
 	return Superdouble(mantissa/x.mantissa,exponent-x.exponent);
 }
 
-//add stilldouble
 Superdouble Superdouble::operator + ( Superdouble  x){
-
-	//only tricky thing is converting them to same exponent
-	if (x.mantissa != 0) {	// (CBR 11.03.2014)
-		if (mantissa!=0) {
-			int exponentdif=x.exponent-exponent;
-			return Superdouble(mantissa+(x.mantissa*(pow(10,exponentdif))),exponent);
-		}
-		else
-			return Superdouble(x.mantissa,x.exponent);
-	}
-	else
-		return Superdouble(mantissa, exponent);
+	return add(mantissa,exponent,x.mantissa,x.exponent);
 }
 
-//add stilldouble
 Superdouble Superdouble::operator - ( Superdouble  x){
-	//only tricky thing is converting them to same exponent
-	if (x.mantissa != 0) {	// (CBR 11.03.2014)
-		if (mantissa!=0) {
-			int exponentdif=x.exponent-exponent;
-			return Superdouble(mantissa-(x.mantissa*(pow(10,exponentdif))),exponent);
-		}
-		else
-			return Superdouble(-1.0*x.mantissa,x.exponent);
-	}
-	else
-		return Superdouble(mantissa, exponent);
+	return add(mantissa,exponent,-x.mantissa,x.exponent);
 }
 
-//add stilldouble
 void Superdouble::operator ++ (){
-	mantissa++;
-	adjustDecimal();
+	*this = add(mantissa,exponent,0.5,1);
 }
 
-//add stilldouble
 void Superdouble::operator -- (){
-	mantissa--;
-	adjustDecimal();
+	*this = add(mantissa,exponent,-0.5,1);
 }
 
-//add stilldouble
 void Superdouble::operator *= (const Superdouble &x){
 	mantissa*=x.mantissa;
 	exponent+=x.exponent;
-	adjustDecimal();
+	normalize();
 }
 
-//add stilldouble
 void Superdouble::operator /= (const Superdouble &x){
 	mantissa/=x.mantissa;
 	exponent-=x.exponent;
-	adjustDecimal();
+	normalize();
 }
 
 void Superdouble::operator += (const Superdouble  &x){
-	//only tricky thing is converting them to same exponent
-	if (x.mantissa != 0) {	// (CBR 11.03.2014)
-		if (mantissa!=0) {
-			if (stilldouble == true && x.stilldouble == true){
-				mantissa += x.mantissa;
-				if (fabs(mantissa) > upperlimit || fabs(mantissa) < lowerlimit){
-					adjustDecimal();
-				}
-			}else{
-				int exponentdif=x.exponent-exponent;
-				mantissa=mantissa+(x.mantissa*(pow(10,exponentdif)));
-				adjustDecimal();
-			}
-		}else {
-			if (stilldouble == true && x.stilldouble == true){
-				mantissa = x.mantissa;
-				exponent=x.exponent;
-			}else{
-				mantissa=x.mantissa;
-				exponent=x.exponent;
-				adjustDecimal();
-			}
-		}
-	}
-
+	*this = add(mantissa,exponent,x.mantissa,x.exponent);
 }
 
-//add stilldouble
 void Superdouble::operator -= (const Superdouble  &x){
-	//only tricky thing is converting them to same exponent
-	if (x.mantissa != 0) {	// (CBR 11.03.2014)
-		if (mantissa!=0) {
-			int exponentdif=x.exponent-exponent;
-			mantissa=mantissa-(x.mantissa*(pow(10,exponentdif)));
-			adjustDecimal();
-		}
-		else {
-			mantissa=-1.0*x.mantissa;
-			exponent=x.exponent;
-			adjustDecimal();
-		}
-	}
+	*this = add(mantissa,exponent,-x.mantissa,x.exponent);
+}
+
+/*
+ * sign of this - x
+ * (as normalized mantissas have the sign of the value,
+ * they compare directly unless both values have the same sign and different exponents)
+ */
+int Superdouble::compare(const Superdouble & x)const{
+	if (mantissa == 0 || x.mantissa == 0 || (mantissa < 0) != (x.mantissa < 0) || exponent == x.exponent)
+		return (mantissa > x.mantissa) - (mantissa < x.mantissa);
+	int sign = mantissa < 0 ? -1 : 1;
+	return exponent > x.exponent ? sign : -sign;
 }
 
 bool Superdouble::operator > (const Superdouble & x)const{
-	if (x.mantissa == 0) {	// (CBR 24.04.2014)
-		if (mantissa > 0)
-			return true;
-		else
-			return false;
-	}
-	else {
-		if (exponent > x.exponent)
-			return true;
-		else if(exponent == x.exponent && mantissa > x.mantissa)
-			return true;
-		else
-			return false;
-	}
+	return compare(x) > 0;
 }
 
 bool Superdouble::operator >= (const Superdouble & x)const{
-	if (x.mantissa == 0) {	// (CBR 24.04.2014)
-		if (mantissa >= 0)
-			return true;
-		else
-			return false;
-	}
-	else {
-		if (exponent > x.exponent)
-			return true;
-		else if(exponent == x.exponent && mantissa >= x.mantissa)
-			return true;
-		else
-			return false;
-	}
+	return compare(x) >= 0;
 }
 
 bool Superdouble::operator < (const Superdouble & x)const{
-	if (x.mantissa == 0) {	// (CBR 24.04.2014)
-		if (mantissa < 0)
-			return true;
-		else
-			return false;
-	}
-	else {
-		if (exponent < x.exponent)
-			return true;
-		else if(exponent == x.exponent && mantissa < x.mantissa)
-			return true;
-		else
-			return false;
-	}
+	return compare(x) < 0;
 }
 
 bool Superdouble::operator <= (const Superdouble & x)const{
-	if (x.mantissa == 0) {	// (CBR 24.04.2014)
-		if (mantissa <= 0)
-			return true;
-		else
-			return false;
-	}
-	else {
-		if (exponent < x.exponent)
-			return true;
-		else if(exponent == x.exponent && mantissa <= x.mantissa)
-			return true;
-		else
-			return false;
-	}
+	return compare(x) <= 0;
 }
 
 bool Superdouble::operator == (const Superdouble & x)const{
-	if (exponent == x.exponent)
-	    if (mantissa == x.mantissa)
-	    	return true;
-	    else
-	    	return false;
-	else
-		return false;
+	return exponent == x.exponent && mantissa == x.mantissa;
 }
 
 bool Superdouble::operator != (const Superdouble & x)const{
-	if (exponent != x.exponent)
-	    return true;
-	else
-	    if (mantissa != x.mantissa)
-	    	return true;
-	    else
-	    	return false;
+	return exponent != x.exponent || mantissa != x.mantissa;
 }
 
 //this just switches the sign of the superdouble
@@ -256,26 +200,11 @@ void Superdouble::switch_sign(){
 	mantissa = -1.0*mantissa;
 }
 
-/*bool Superdouble::operator > (double x){
-	if (double() > x)
-		return true;
-	else
-		return false;
-}*/
-
 Superdouble Superdouble::getLn(){
-	//ln(a * 10^b) = ln(a) + ln(10^b) = ln(a) + log10 (10^b) / log10 (e^1) = ln(a) + b/log10(e^1)
-	//Superdouble result(log(mantissa)+(1.0*(exponent))/log10l(exp(1)),0);
-
-	//or (CBR 28.02.2014)
-	//ln(a * 10^b) = ln(a) + ln(10^b) = ln(a) + b log(10)
-	return Superdouble(log(mantissa)+(double(exponent)*log(10)),0);
+	//ln(a * 2^b) = ln(a) + b ln(2)
+	return Superdouble(log(mantissa)+(double(exponent)*log(2.0)),0);
 }
 
 Superdouble Superdouble::abs(){
-	if (mantissa < 0)
-		return Superdouble(-mantissa,exponent);
-	else
-		return Superdouble(mantissa,exponent);
+	return Superdouble(fabs(mantissa),exponent);
 }
-
@@ -1,6 +1,6 @@
 /*
- * superdouble, a class with long double precision but less subject to overflow or underflow
- * superdouble X=mantissa * 10^exponent
+ * superdouble, a class with double precision but less subject to overflow or underflow
+ * superdouble X=mantissa * 2^exponent, with 0.5 <= |mantissa| < 1 (or mantissa 0)
  *
  * Copyright Brian C. O'Meara, Oct. 2, 2008
  * http://www.brianomeara.info
@@ -33,18 +33,21 @@
 using namespace std;
 
 
+/*
+ * 16 bytes: the exponent is kept in base 2, so that normalizing only takes
+ * the exponent field of the double, with no loop and no call to pow()
+ * (frexp only for the rare subnormal, infinite or nan mantissas)
+ */
 class Superdouble  {
 private:
-	long double mantissa;
+	double mantissa;
 	int exponent;
-	bool stilldouble;
-	double upperlimit;
-	double lowerlimit;
-	void adjustDecimal();
+	void normalize();
+	int compare(const Superdouble &x)const;
 	friend ostream& operator << (ostream& os, const Superdouble& x);
 	
 public:
-	Superdouble(long double mantissa=1.0, int exponent=0);
+	Superdouble(double mantissa=1.0, int exponent=0);
 	~Superdouble();
 	Superdouble operator * ( Superdouble x);
 	Superdouble operator * ( double x);
@@ -63,13 +66,13 @@ public:
 	bool operator > (const Superdouble &x)const ;
 	bool operator >= (const Superdouble &x)const ;
 	bool operator <= (const Superdouble &x)const ;
-	int getExponent();
+	int getExponent();	//	base 2
 	double getMantissa();
 	Superdouble getLn();
 	Superdouble abs();
 	void switch_sign();
 	
-	operator double() {return mantissa*pow(10.,exponent);};
+	operator double() {return ldexp(mantissa,exponent);};
 	
 };
 #endif
@@ -21,6 +21,11 @@ from reader import Reader, LinesAutomaton
 import re
 
 
+def rate(value):
+    """Free rates cells are kept as '?', other values are floats."""
+    return value if value == "?" else float(value)
+
+
 class MatricesChecker(Checker):
 
     expecting_stdout = True
@@ -76,7 +81,7 @@ class MatricesChecker(Checker):
                     e = row[j]
                     a, leg = leg.split("\t", 1)
                     if self.type == "rates":
-                        a = 1.0 if a == " . " else float(a)
+                        a = 1.0 if a == " . " else rate(a)
                     if e != a:
                         mess = f"Invalid {self.type} value in legacy display, "
                         mess += f"period {p}, row {i}, column {j}. "
@@ -102,7 +107,7 @@ class MatricesChecker(Checker):
             )
 
         # Check full display.
-        convert = str if self.type == "adjacency" else float
+        convert = str if self.type == "adjacency" else rate
         matrices = [
             [[convert(v) for v in row.split()] for row in p.strip().split("\n")]
             for p in full.strip().split("---")
@@ -199,7 +204,7 @@ class MatricesAutomaton(LinesAutomaton):
                 period[i][j] = period[j][i] = value
             else:
                 try:
-                    period[i][j] = float(value)
+                    period[i][j] = rate(value)
                 except ValueError:
                     raise ParseError(
                         f"Expected floating number, found {repr(value)} instead",